@@ -44,7 +44,7 @@ class InitSystem : public System {
   }
 
  public:
-  InitSystem() : _reset("RESET") {}
+  InitSystem() : _reset("RESET") { wakesOn(_reset); }
 
   Result process(const Ptr<Memory>& mem,
                  Ptr<InputManager> const& input) override {
@@ -64,25 +64,36 @@ class InitSystem : public System {
 
 class CursorRenderingSystem : public System {
  public:
-  Result process(Ptr<Memory> const& mem);
-  CursorRenderingSystem(Ptr<IShapeRenderer> rend) : _renderer(rend) {}
+  Result init(Ptr<Memory> const& mem) override;
+  Result process(Ptr<Memory> const& mem) override;
+  CursorRenderingSystem(Ptr<IShapeRenderer> rend) : _renderer(rend) {
+    reads<Selected, Camera>();
+    // draws, so it stays on the thread owning the window once pipelined
+    renders();
+  }
 
  private:
   Ptr<IShapeRenderer> _renderer;
+  Entity _cross;
 };
 
+Result CursorRenderingSystem::init(const Ptr<Memory>& mem) {
+  // on the board, the snapshot drawn once pipelined is copied over
+  _cross = mem->createEntity("cursor");
+  return ok();
+}
+
 Result CursorRenderingSystem::process(const Ptr<Memory>& mem) {
-  Selected cursor;
-  if (!mem->read(cursor)) {
+  Selected const* cursor = mem->resource<Selected>();
+  if (!cursor) {
     return error("no cursor to display");
   }
-  Camera camera;
-  if (!mem->read(camera)) {
+  Camera const* camera = mem->resource<Camera>();
+  if (!camera) {
     return error("no camera");
   }
-  static auto cross = mem->createEntity("cursor");
-  _renderer->draw(cross, AABox3f(cursor.point, Vec3f::all(1.f)),
-                  Mat4x4f::identity(), camera.view(), camera.projection());
+  _renderer->draw(_cross, AABox3f(cursor->point, Vec3f::all(1.f)),
+                  Mat4x4f::identity(), camera->view(), camera->projection());
   return ok();
 }
 
@@ -96,32 +107,35 @@ int main(void) {
   Ptr<IShapeRenderer> shapeRenderer(new GlShapeRenderer());
 
   auto AddFunc = [](Ptr<Memory> const& mem) -> Result {
-    Selected cursor;
-    if (!mem->read(cursor)) {
+    Selected const* cursor = mem->resource<Selected>();
+    if (!cursor) {
       return error("no cursor to display");
     }
-    makeCube("s", cursor.point, Vec3f::all(1.f), 1.f, mem);
+    makeCube("s", cursor->point, Vec3f::all(1.f), 1.f, mem);
     return ok();
   };
 
   auto RmFunc = [](Ptr<Memory> const& mem) -> Result {
-    Selected cursor;
-    if (!mem->read(cursor)) {
+    Selected const* cursor = mem->resource<Selected>();
+    if (!cursor) {
       return error("no 3d cursor");
     }
-    if (cursor.entity) {
-      mem->remove(cursor.entity);
+    if (cursor->entity) {
+      mem->remove(cursor->entity);
     }
     return true;
   };
 
+  Ptr<Profiler> profiler(new Profiler);
+
   Engine engine;
   engine.setBoard(board)
       .setWindow(window)
       .setKeyboard(keyboard)
       .setMouse(mouse)
+      .setProfiler(profiler)
       .makeSystem<InitSystem>()
-      .makeSystem<DebugHidSystem>(window, textRenderer)
+      .makeSystem<DebugHidSystem>(window, textRenderer, profiler)
       .makeSystem<FixedCameraSystem>(window)
       .makeSystem<HitBoxRenderingSystem>(shapeRenderer)
       .makeSystem<PhysicsSystem>()
@@ -142,5 +156,7 @@ int main(void) {
     return -1;
   }
   std::cout << "RUN: " << engine.run().message() << std::endl;
+  std::cout << "TRACE: " << profiler->exportTrace("aabb_cluster.json").message()
+            << std::endl;
   return 0;
 }
@@ -0,0 +1,183 @@
+#include <arty/core/aabb_tree.hpp>
+#include <arty/core/hash_grid.hpp>
+#include <arty/impl/engine.hpp>
+#include <arty/impl/physics_system.hpp>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+using namespace arty;
+
+/**
+ * @brief The aabb_cluster scene at scale: boxes falling on a floor, the
+ * density of the original 50 cubes kept
+ *
+ * With tiles, the floor is a board of unit tiles that touch each other, as
+ * in the playground.
+ */
+void makeScene(Memory& mem, std::size_t cubes, bool tiles = false) {
+  float side = 10.f * std::sqrt(static_cast<float>(cubes) / 50.f);
+  if (tiles) {
+    auto n = static_cast<int>(side);
+    for (int x = -n; x < n; ++x) {
+      for (int y = -n; y < n; ++y) {
+        auto tile = mem.createEntity("tile");
+        mem.write(tile, AABox3f(Vec3f(), Vec3f(0.5f, 0.5f, 1.f)));
+        mem.write(tile, Tf3f(Vec3f(static_cast<float>(x) + 0.5f,
+                                   static_cast<float>(y) + 0.5f, 0.f)));
+      }
+    }
+  } else {
+    auto floor = mem.createEntity("floor");
+    mem.write(floor, AABox3f(Vec3f(), Vec3f(side, side, 1.f)));
+    Particle fixed;
+    fixed.setMass(0);
+    mem.write(floor, fixed);
+  }
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> xy(-side, side);
+  std::uniform_real_distribution<float> z(5.f, 20.f);
+  std::uniform_real_distribution<float> len(0.1f, 1.f);
+  for (std::size_t n = 0; n < cubes; ++n) {
+    auto e = mem.createEntity("random");
+    mem.write(e, AABox3f(Vec3f(), Vec3f(len(gen), len(gen), len(gen))));
+    Particle p;
+    p.position = vector_t(xy(gen), xy(gen), z(gen));
+    p.setMass(1);
+    mem.write(e, p);
+  }
+}
+
+/**
+ * @brief The pair loop the broadphase replaced, for one detection
+ */
+std::size_t bruteForce(Memory& mem) {
+  std::size_t hits = 0;
+  Physics physics;
+  for (auto [e1, t1, b1] : mem.view<Tf3f, AABox3f>()) {
+    for (auto [e2, t2, b2] : mem.view<Tf3f, AABox3f>()) {
+      if (e1 < e2 && physics.detectCollision(t1, b1, t2, b2).exist()) {
+        ++hits;
+      }
+    }
+  }
+  return hits;
+}
+
+/**
+ * @brief milliseconds per frame of the scene simulated with a broadphase
+ */
+double simulate(Ptr<Memory> const& mem, Ptr<IBroadphase> const& broadphase,
+                std::size_t frames) {
+  Ptr<PhysicsSystem> physics(new PhysicsSystem);
+  physics->setBroadphase(broadphase);
+  Engine engine;
+  engine.setBoard(mem).setHeadless(60.).addSystem(physics);
+  engine.start();
+  auto start = std::chrono::steady_clock::now();
+  engine.run(frames);
+  auto end = std::chrono::steady_clock::now();
+  engine.stop();
+  return std::chrono::duration<double, std::milli>(end - start).count() /
+         static_cast<double>(frames);
+}
+
+/**
+ * @brief milliseconds per sweep of boxes of similar sizes, all of them
+ * moving a little or none
+ */
+double sweeps(IBroadphase& broadphase, std::size_t count, bool moving) {
+  std::mt19937 gen(42);
+  float side = 10.f * std::sqrt(static_cast<float>(count) / 50.f);
+  std::uniform_real_distribution<float> xy(-side, side);
+  std::uniform_real_distribution<float> z(0.f, 3.f);
+  std::uniform_real_distribution<float> len(0.1f, 1.f);
+  std::uniform_real_distribution<float> step(-0.01f, 0.01f);
+  std::vector<AABox3f> boxes;
+  for (std::size_t i = 0; i < count; ++i) {
+    boxes.emplace_back(Vec3f(xy(gen), xy(gen), z(gen)),
+                       Vec3f(len(gen), len(gen), len(gen)));
+  }
+  std::size_t const rounds = 100;
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t r = 0; r < rounds; ++r) {
+    for (std::size_t i = 0; i < count; ++i) {
+      if (moving) {
+        boxes[i] = AABox3f(
+            boxes[i].center() + Vec3f(step(gen), step(gen), step(gen)),
+            boxes[i].halfLength());
+      }
+      broadphase.update(Entity(static_cast<Entity::index_type>(i + 1), 1),
+                        boxes[i]);
+    }
+    broadphase.sweep();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() /
+         static_cast<double>(rounds);
+}
+
+int main() {
+  std::size_t const frames = 60;
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "30 physics steps per frame, " << frames
+            << " frames, ms per frame" << std::endl;
+  std::cout << std::setw(8) << "boxes" << std::setw(8) << "floor"
+            << std::setw(12) << "pair loop" << std::setw(10) << "sap"
+            << std::setw(10) << "tree" << std::setw(10) << "grid"
+            << std::setw(8) << "pairs" << std::endl;
+  for (std::size_t cubes : {500, 2000, 10000}) {
+    for (bool tiles : {false, true}) {
+      if (tiles && cubes > 2000) {
+        // 80000 tiles, too slow to wait for
+        continue;
+      }
+      std::vector<double> times;
+      std::vector<Ptr<IBroadphase>> broadphases{
+          std::make_shared<SweepAndPrune>(), std::make_shared<AABBTree>(),
+          // as large as the largest cubes
+          std::make_shared<SpatialHashGrid>(2.f)};
+      Ptr<Memory> mem;
+      for (auto const& broadphase : broadphases) {
+        mem.reset(new Memory);
+        makeScene(*mem, cubes, tiles);
+        times.push_back(simulate(mem, broadphase, frames));
+      }
+      std::size_t pairs = 0;
+      double loop = 0.;
+      if (cubes <= 2000 && !tiles) {
+        auto start = std::chrono::steady_clock::now();
+        pairs = bruteForce(*mem);
+        auto end = std::chrono::steady_clock::now();
+        // per frame, there is one detection per step
+        loop = 30. * std::chrono::duration<double, std::milli>(end - start)
+                         .count();
+      }
+      std::cout << std::setw(8) << cubes << std::setw(8)
+                << (tiles ? "tiles" : "box") << std::setw(12) << loop;
+      for (double time : times) {
+        std::cout << std::setw(10) << time;
+      }
+      std::cout << std::setw(8) << pairs << std::endl;
+    }
+  }
+  std::cout << std::endl << "broadphase alone, ms per sweep" << std::endl;
+  std::cout << std::setw(8) << "boxes" << std::setw(8) << "motion"
+            << std::setw(12) << "" << std::setw(10) << "sap" << std::setw(10)
+            << "tree" << std::setw(10) << "grid" << std::endl;
+  for (std::size_t count : {2000, 10000, 50000}) {
+    for (bool moving : {false, true}) {
+      SweepAndPrune sap;
+      AABBTree tree;
+      SpatialHashGrid grid(2.f);
+      std::cout << std::setw(8) << count << std::setw(8)
+                << (moving ? "moving" : "still") << std::setw(12) << ""
+                << std::setw(10) << sweeps(sap, count, moving)
+                << std::setw(10) << sweeps(tree, count, moving)
+                << std::setw(10) << sweeps(grid, count, moving) << std::endl;
+    }
+  }
+  return 0;
+}
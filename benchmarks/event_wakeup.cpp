@@ -0,0 +1,99 @@
+#include <arty/core/scheduler.hpp>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+using namespace arty;
+
+/**
+ * @brief What EventSystem used to do: run every frame and poll its event
+ */
+class PollingSystem : public System {
+ public:
+  PollingSystem(Event const& event, EventSystem::job_func job)
+      : _event(event), _job(job) {}
+
+  Result process(Ptr<Memory> const& board,
+                 Ptr<InputManager> const& inputs) override {
+    if (inputs->pop(_event)) {
+      return _job(board);
+    }
+    return ok();
+  }
+
+ private:
+  Event _event;
+  EventSystem::job_func _job;
+};
+
+struct Spawned {
+  int value;
+};
+
+/**
+ * @brief Per frame cost of pairs of SPAWN/DELETE systems that are idle
+ * most of the time
+ */
+double run(bool polling, std::size_t pairs, std::size_t frames) {
+  Ptr<Memory> mem(new Memory);
+  Ptr<Keyboard> keyboard(new Keyboard);
+  Ptr<InputManager> inputs(new InputManager);
+  inputs->setKeyboard(keyboard);
+  auto spawn = [](Ptr<Memory> const& board) {
+    board->write(board->createEntity(), Spawned{0});
+    return ok();
+  };
+  auto remove = [](Ptr<Memory> const& board) {
+    board->remove<Spawned>();
+    return ok();
+  };
+  std::vector<Ptr<System>> systems;
+  for (std::size_t i = 0; i < pairs; ++i) {
+    Event spawnEvent("SPAWN");
+    Event deleteEvent("DELETE");
+    if (polling) {
+      systems.emplace_back(new PollingSystem(spawnEvent, spawn));
+      systems.emplace_back(new PollingSystem(deleteEvent, remove));
+    } else {
+      systems.emplace_back(new EventSystem(
+          Input(Keyboard::S, Device::PRESS), spawnEvent, spawn));
+      systems.emplace_back(new EventSystem(
+          Input(Keyboard::D, Device::PRESS), deleteEvent, remove));
+    }
+    if (i == 0) {
+      inputs->attach(Keyboard::S, Device::PRESS, spawnEvent);
+      inputs->attach(Keyboard::D, Device::PRESS, deleteEvent);
+    }
+  }
+  Scheduler scheduler;
+  scheduler.build(systems);
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t frame = 0; frame < frames; ++frame) {
+    if (frame % 100 == 0) {
+      keyboard->process(Keyboard::S, Device::PRESS);
+    } else if (frame % 100 == 50) {
+      keyboard->process(Keyboard::D, Device::PRESS);
+    }
+    scheduler.run(mem, inputs);
+    inputs->flush();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count() /
+         static_cast<double>(frames);
+}
+
+int main() {
+  std::size_t const frames = 2000;
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << std::setw(8) << "pairs" << std::setw(14) << "polling"
+            << std::setw(14) << "wakeups" << std::setw(11) << "speedup"
+            << "   (us/frame)" << std::endl;
+  for (std::size_t pairs : {10, 100, 500}) {
+    double polling = run(true, pairs, frames);
+    double wakeups = run(false, pairs, frames);
+    std::cout << std::setw(8) << pairs << std::setw(14) << polling
+              << std::setw(14) << wakeups << std::setw(10) << polling / wakeups
+              << "x" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,170 @@
+#include <any>
+#include <arty/core/geometry.hpp>
+#include <arty/core/memory.hpp>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <vector>
+
+using namespace arty;
+
+/**
+ * @brief The previous Memory backend, kept here as the reference
+ *
+ * Every component lives in a std::any inside a map keyed by entity, inside
+ * a map keyed by the component type name
+ */
+class MapMemory {
+ public:
+  Entity createEntity() { return Entity(++_count, 0); }
+
+  template <typename T>
+  bool write(Entity const& entity, T const& val) {
+    _components[typeid(T).name()][entity] = val;
+    return true;
+  }
+
+  template <typename T>
+  bool read(Entity const& entity, T& val) {
+    auto it = _components.find(typeid(T).name());
+    if (it != _components.end()) {
+      auto it2 = it->second.find(entity);
+      if (it2 != it->second.end()) {
+        val = std::any_cast<T>(it2->second);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool remove(Entity const& entity) {
+    for (auto& comp : _components) {
+      comp.second.erase(entity);
+    }
+    return true;
+  }
+
+  template <typename T>
+  Result process(std::function<Result(Entity const&, T const&)> func) {
+    auto container = _components[typeid(T).name()];
+    for (auto const& it : container) {
+      return_if_error(func(it.first, *std::any_cast<T>(&it.second)));
+    }
+    return ok();
+  }
+
+  template <typename T1, typename T2>
+  Result process(
+      std::function<Result(Entity const&, T1 const&, T2 const&)> func) {
+    auto container1 = _components[typeid(T1).name()];
+    auto container2 = _components[typeid(T2).name()];
+    auto c1It = container1.begin();
+    auto c2It = container2.begin();
+    while (c1It != container1.end() && c2It != container2.end()) {
+      if (c1It->first < c2It->first) {
+        ++c1It;
+        continue;
+      }
+      if (c2It->first < c1It->first) {
+        ++c2It;
+        continue;
+      }
+      return_if_error(func(c1It->first, *std::any_cast<T1>(&c1It->second),
+                           *std::any_cast<T2>(&c2It->second)));
+      ++c1It;
+      ++c2It;
+    }
+    return ok();
+  }
+
+ private:
+  std::map<std::string, std::map<Entity, std::any>> _components;
+  Entity::index_type _count = 0;
+};
+
+template <typename Func>
+double measure(Func func) {
+  auto start = std::chrono::steady_clock::now();
+  func();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+struct Timings {
+  double write;
+  double read;
+  double process;
+  double process2;
+  double remove;
+};
+
+template <class Mem>
+Timings run(std::size_t n) {
+  Mem mem;
+  std::vector<Entity> entities;
+  entities.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    entities.push_back(mem.createEntity());
+  }
+  Timings t;
+  float sink = 0.f;
+  t.write = measure([&] {
+    for (auto const& e : entities) {
+      mem.write(e, Tf3f(Vec3f::all(static_cast<float>(e.id()))));
+      mem.write(e, AABox3f::unit());
+    }
+  });
+  t.read = measure([&] {
+    Tf3f tf;
+    for (auto const& e : entities) {
+      mem.read(e, tf);
+      sink += tf.translation().x();
+    }
+  });
+  t.process = measure([&] {
+    mem.template process<Tf3f>([&](Entity const&, Tf3f const& tf) -> Result {
+      sink += tf.translation().x();
+      return ok();
+    });
+  });
+  t.process2 = measure([&] {
+    mem.template process<Tf3f, AABox3f>(
+        [&](Entity const&, Tf3f const& tf, AABox3f const& b) -> Result {
+          sink += tf.translation().x() + b.halfLength().x();
+          return ok();
+        });
+  });
+  t.remove = measure([&] {
+    for (auto const& e : entities) {
+      mem.remove(e);
+    }
+  });
+  if (sink < 0.f) {
+    std::cout << sink << std::endl;
+  }
+  return t;
+}
+
+void print(std::string const& op, double map, double dense) {
+  std::cout << std::setw(12) << op << std::setw(14) << map << std::setw(14)
+            << dense << std::setw(10) << map / dense << "x" << std::endl;
+}
+
+int main() {
+  std::cout << std::fixed << std::setprecision(2);
+  for (std::size_t n : {10000, 100000, 1000000}) {
+    Timings map = run<MapMemory>(n);
+    Timings dense = run<Memory>(n);
+    std::cout << n << " entities" << std::endl;
+    std::cout << std::setw(12) << "op" << std::setw(14) << "map (ms)"
+              << std::setw(14) << "dense (ms)" << std::setw(11) << "speedup"
+              << std::endl;
+    print("write", map.write, dense.write);
+    print("read", map.read, dense.read);
+    print("process", map.process, dense.process);
+    print("process2", map.process2, dense.process2);
+    print("remove", map.remove, dense.remove);
+  }
+  return 0;
+}
@@ -0,0 +1,53 @@
+#include <arty/impl/physics_system.hpp>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+using namespace arty;
+
+/**
+ * @brief Time PhysicsSystem::integrateMotion over many particles, which runs
+ * by chunks on the thread pool
+ */
+double run(std::size_t threads, std::size_t particles, int steps) {
+  Ptr<Memory> mem(new Memory);
+  if (threads > 1) {
+    mem->setThreadPool(Ptr<ThreadPool>(new ThreadPool(threads)));
+  }
+  for (std::size_t i = 0; i < particles; ++i) {
+    Entity e = mem->createEntity();
+    Particle p;
+    p.position = vector_t(static_cast<double>(i % 1000), 0, 10);
+    p.velocity = vector_t(0, 1, 0);
+    p.setMass(1);
+    mem->write(e, p);
+    mem->write(e, p.transform());
+  }
+  PhysicsSystem physics;
+  auto start = std::chrono::steady_clock::now();
+  for (int s = 0; s < steps; ++s) {
+    physics.integrateMotion(mem);
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() /
+         steps;
+}
+
+int main() {
+  std::size_t const particles = 100000;
+  int const steps = 30;
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << particles << " particles, integrateMotion" << std::endl;
+  std::cout << std::setw(8) << "threads" << std::setw(14) << "ms/step"
+            << std::setw(11) << "speedup" << std::endl;
+  double serial = 0.;
+  for (std::size_t threads : {1, 2, 4, 8}) {
+    double ms = run(threads, particles, steps);
+    if (threads == 1) {
+      serial = ms;
+    }
+    std::cout << std::setw(8) << threads << std::setw(14) << ms
+              << std::setw(10) << serial / ms << "x" << std::endl;
+  }
+  return 0;
+}
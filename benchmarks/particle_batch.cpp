@@ -0,0 +1,126 @@
+#include <arty/impl/particle_batch.hpp>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+using namespace arty;
+
+using Isa = ParticleBatch::Isa;
+
+std::vector<Particle> makeParticles(std::size_t count) {
+  std::vector<Particle> particles(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    particles[i].position = vector_t(static_cast<double>(i % 1000), 0, 10);
+    particles[i].velocity = vector_t(0, 1, 0);
+    particles[i].setMass(1);
+  }
+  return particles;
+}
+
+// about 10 million particle steps per measure
+std::size_t stepsFor(std::size_t count) {
+  return std::max<std::size_t>(1, 10000000 / count);
+}
+
+template <typename Func>
+double nanosPerParticle(std::size_t count, Func&& func) {
+  std::size_t steps = stepsFor(count);
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t s = 0; s < steps; ++s) {
+    func();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         static_cast<double>(steps * count);
+}
+
+/**
+ * @brief Physics::integrateMotion on each particle, as before batches
+ */
+double oneByOne(std::size_t count) {
+  std::vector<Particle> particles = makeParticles(count);
+  Physics physics;
+  return nanosPerParticle(count, [&] {
+    for (auto& p : particles) {
+      physics.integrateMotion(p, 1. / 1800.);
+    }
+  });
+}
+
+/**
+ * @brief the power of the damping computed once, as PhysicsSystem does
+ */
+double cached(std::size_t count) {
+  std::vector<Particle> particles = makeParticles(count);
+  Physics physics;
+  number_t factor = std::pow(particles.front().damping, 1. / 1800.);
+  return nanosPerParticle(count, [&] {
+    for (auto& p : particles) {
+      physics.integrateMotion(p, 1. / 1800., factor);
+    }
+  });
+}
+
+/**
+ * @brief particles copied in a batch, integrated and copied back: what a
+ * batch costs to Particle components
+ */
+double roundTrip(std::size_t count) {
+  std::vector<Particle> particles = makeParticles(count);
+  ParticleBatch batch;
+  return nanosPerParticle(count, [&] {
+    batch.clear();
+    for (auto const& p : particles) {
+      batch.push(p);
+    }
+    batch.integrate(1. / 1800.);
+    for (std::size_t i = 0; i < particles.size(); ++i) {
+      batch.store(i, particles[i]);
+    }
+  });
+}
+
+/**
+ * @brief the integration alone, on particles kept in the batch
+ */
+double kernel(std::size_t count, Isa isa) {
+  std::vector<Particle> particles = makeParticles(count);
+  ParticleBatch batch;
+  batch.setIsa(isa);
+  for (auto const& p : particles) {
+    batch.push(p);
+  }
+  return nanosPerParticle(count, [&] { batch.integrate(1. / 1800.); });
+}
+
+int main() {
+  std::vector<std::pair<Isa, char const*>> isas{{Isa::SCALAR, "scalar"}};
+  if (ParticleBatch::best(true) != Isa::SCALAR) {
+    isas.emplace_back(Isa::SSE2, "sse2");
+  }
+  if (ParticleBatch::best(true) == Isa::AVX2) {
+    isas.emplace_back(Isa::AVX2, "avx2");
+  }
+  if (ParticleBatch::best(false) == Isa::AVX2_FMA) {
+    isas.emplace_back(Isa::AVX2_FMA, "fma");
+  }
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "ns per particle and step" << std::endl;
+  std::cout << std::setw(10) << "particles" << std::setw(12) << "one by one"
+            << std::setw(10) << "cached" << std::setw(12) << "round trip";
+  for (auto const& isa : isas) {
+    std::cout << std::setw(10) << isa.second;
+  }
+  std::cout << std::endl;
+  for (std::size_t count : {1000, 100000, 1000000}) {
+    std::cout << std::setw(10) << count << std::setw(12) << oneByOne(count)
+              << std::setw(10) << cached(count) << std::setw(12)
+              << roundTrip(count);
+    for (auto const& isa : isas) {
+      std::cout << std::setw(10) << kernel(count, isa.first);
+    }
+    std::cout << std::endl;
+  }
+  return 0;
+}
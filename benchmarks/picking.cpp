@@ -0,0 +1,80 @@
+#include <arty/impl/mouse_system.hpp>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+using namespace arty;
+
+/**
+ * @brief The loop MouseSystem used before the spatial index
+ */
+Entity linearPick(Memory& mem, Line3f const& line) {
+  Entity selected;
+  auto closest = std::numeric_limits<float>::max();
+  for (auto [e, t, b] : mem.view<Tf3f, AABox3f>()) {
+    auto intersection = Geo::intersect(line, b.move(t));
+    if (intersection.exist()) {
+      auto dist = (line.origin() - intersection.value()).normsqr();
+      if (dist < closest) {
+        selected = e;
+        closest = dist;
+      }
+    }
+  }
+  return selected;
+}
+
+int main() {
+  std::size_t const picks = 200;
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "one pick per frame, a tenth of the boxes move" << std::endl;
+  std::cout << std::setw(8) << "boxes" << std::setw(16) << "linear"
+            << std::setw(16) << "index" << std::endl;
+  for (std::size_t boxes : {1000, 10000, 100000}) {
+    Ptr<Memory> mem(new Memory);
+    std::mt19937 gen(3);
+    float side = 2.f * std::cbrt(static_cast<float>(boxes));
+    std::uniform_real_distribution<float> pos(-side, side);
+    std::uniform_real_distribution<float> step(-0.05f, 0.05f);
+    std::vector<Entity> entities;
+    for (std::size_t i = 0; i < boxes; ++i) {
+      Entity e = mem->createEntity();
+      mem->write(e, Tf3f(Vec3f(pos(gen), pos(gen), pos(gen))));
+      mem->write(e, AABox3f(Vec3f(), Vec3f::all(0.5f)));
+      entities.push_back(e);
+    }
+    Camera camera;
+    camera.perspective(radians(45.f), 16.f / 9.f, 0.1f, 1000.f);
+    camera.lookAt(Vec3f::all(2.f * side), Vec3f(), Vec3f(0.f, 0.f, 1.f));
+    mem->write(camera);
+    Ptr<InputManager> inputs(new InputManager);
+    MouseSystem mouse;
+    std::size_t hits = 0;
+    double linear = 0.;
+    double index = 0.;
+    for (std::size_t n = 0; n < picks; ++n) {
+      for (std::size_t i = n % 10; i < boxes; i += 10) {
+        Tf3f* tf = mem->get<Tf3f>(entities[i]);
+        *tf = Tf3f(tf->translation() + Vec3f(step(gen), step(gen), step(gen)));
+      }
+      mem->advance();
+      auto start = std::chrono::steady_clock::now();
+      mouse.process(mem, inputs);
+      auto end = std::chrono::steady_clock::now();
+      index += std::chrono::duration<double, std::milli>(end - start).count();
+      start = std::chrono::steady_clock::now();
+      Entity e = linearPick(*mem, camera.raycast(Camera::pixel_type()));
+      end = std::chrono::steady_clock::now();
+      linear += std::chrono::duration<double, std::milli>(end - start).count();
+      hits += e == mem->resource<Selected>()->entity;
+    }
+    std::cout << std::setw(8) << boxes << std::setw(13) << linear / picks
+              << " ms" << std::setw(13) << index / picks << " ms";
+    if (hits != picks) {
+      std::cout << "  " << picks - hits << " picks differ";
+    }
+    std::cout << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,74 @@
+#include <arty/impl/engine.hpp>
+#include <arty/impl/physics_system.hpp>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+using namespace arty;
+
+/**
+ * @brief Stands for the draw submission: walks every box of the snapshot
+ */
+class SubmitSystem : public System {
+ public:
+  SubmitSystem() {
+    reads<Tf3f, AABox3f>();
+    renders();
+  }
+
+  Result process(Ptr<Memory> const& mem) override {
+    for (auto [e, tf, box] : mem->view<Tf3f, AABox3f>()) {
+      (void)e;
+      for (int i = 0; i < 64; ++i) {
+        sink += std::sin(tf.translation().z() + box.halfLength().x() * i);
+      }
+    }
+    return ok();
+  }
+
+  float sink = 0.f;
+};
+
+double run(bool pipelined, std::size_t cubes, std::size_t frames) {
+  Ptr<Memory> mem(new Memory);
+  for (std::size_t i = 0; i < cubes; ++i) {
+    Entity e = mem->createEntity();
+    mem->write(e, AABox3f(Vec3f(), Vec3f::all(0.4f)));
+    Particle p;
+    p.position = vector_t(static_cast<double>(i % 100),
+                          static_cast<double>(i / 100), 10);
+    p.setMass(1);
+    mem->write(e, p);
+  }
+  Engine engine;
+  engine.setBoard(mem)
+      .setHeadless(60.)
+      .setStepRate(600.)
+      .setPipelined(pipelined)
+      .makeSystem<PhysicsSystem>()
+      .makeSystem<SubmitSystem>();
+  engine.start();
+  auto start = std::chrono::steady_clock::now();
+  engine.run(frames);
+  auto end = std::chrono::steady_clock::now();
+  engine.stop();
+  return std::chrono::duration<double, std::milli>(end - start).count() /
+         static_cast<double>(frames);
+}
+
+int main() {
+  std::size_t const cubes = 400;
+  std::size_t const frames = 30;
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << cubes << " falling boxes, 10 physics steps per frame"
+            << std::endl;
+  double serial = run(false, cubes, frames);
+  double pipelined = run(true, cubes, frames);
+  std::cout << std::setw(12) << "serial" << std::setw(12) << serial
+            << " ms/frame" << std::endl;
+  std::cout << std::setw(12) << "pipelined" << std::setw(12) << pipelined
+            << " ms/frame" << std::setw(10) << serial / pipelined << "x"
+            << std::endl;
+  return 0;
+}
@@ -0,0 +1,134 @@
+#include <arty/core/memory.hpp>
+#include <arty/impl/physics.hpp>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+using namespace arty;
+
+/**
+ * @brief Per entity cost of Memory::process depending on the callback type,
+ * on the pair loop of the collision detection over the aabb_cluster scene
+ */
+
+using Outer = std::function<Result(Entity const&, Tf3f const&,
+                                   AABox3f const&)>;
+
+void makeScene(Memory& mem, std::size_t cubes) {
+  auto floor = mem.createEntity("floor");
+  mem.write(floor, AABox3f(Vec3f(), Vec3f(5.f, 5.f, 1.f)));
+  mem.write(floor, Tf3f());
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> xy(-5.f, 5.f);
+  std::uniform_real_distribution<float> z(5.f, 20.f);
+  std::uniform_real_distribution<float> len(0.1f, 2.f);
+  for (std::size_t n = 0; n < cubes; ++n) {
+    auto e = mem.createEntity("random");
+    mem.write(e, AABox3f(Vec3f(), Vec3f(len(gen), len(gen), len(gen))));
+    mem.write(e, Tf3f(Vec3f(xy(gen), xy(gen), z(gen))));
+  }
+}
+
+bool overlap(Tf3f const& t1, AABox3f const& b1, Tf3f const& t2,
+             AABox3f const& b2) {
+  Vec3f d = t1.translation() - t2.translation();
+  Vec3f l = b1.halfLength() + b2.halfLength();
+  return std::abs(d.x()) < l.x() && std::abs(d.y()) < l.y() &&
+         std::abs(d.z()) < l.z();
+}
+
+template <typename Func>
+double measure(Func func, int repeat) {
+  double best = 1e30;
+  for (int r = 0; r < repeat; ++r) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    auto end = std::chrono::steady_clock::now();
+    best = std::min(
+        best, std::chrono::duration<double, std::nano>(end - start).count());
+  }
+  return best;
+}
+
+int main() {
+  std::size_t const cubes = 1000;
+  int const repeat = 10;
+  Memory mem;
+  makeScene(mem, cubes);
+  double visits = static_cast<double>((cubes + 1) * (cubes + 1));
+  std::size_t hits = 0;
+
+  // what every process call used to go through
+  double function = measure(
+      [&] {
+        Outer first = [&](Entity const& e1, Tf3f const& t1,
+                          AABox3f const& b1) -> Result {
+          Outer second = [&](Entity const& e2, Tf3f const& t2,
+                             AABox3f const& b2) -> Result {
+            if (e1 < e2 && overlap(t1, b1, t2, b2)) {
+              ++hits;
+            }
+            return ok();
+          };
+          return mem.process<Tf3f, AABox3f>(second);
+        };
+        mem.process<Tf3f, AABox3f>(first);
+      },
+      repeat);
+  double result = measure(
+      [&] {
+        mem.process<Tf3f, AABox3f>(
+            [&](Entity const& e1, Tf3f const& t1, AABox3f const& b1) {
+              return mem.process<Tf3f, AABox3f>(
+                  [&](Entity const& e2, Tf3f const& t2,
+                      AABox3f const& b2) -> Result {
+                    if (e1 < e2 && overlap(t1, b1, t2, b2)) {
+                      ++hits;
+                    }
+                    return ok();
+                  });
+            });
+      },
+      repeat);
+  double plain = measure(
+      [&] {
+        mem.process<Tf3f, AABox3f>(
+            [&](Entity const& e1, Tf3f const& t1, AABox3f const& b1) {
+              mem.process<Tf3f, AABox3f>(
+                  [&](Entity const& e2, Tf3f const& t2, AABox3f const& b2) {
+                    if (e1 < e2 && overlap(t1, b1, t2, b2)) {
+                      ++hits;
+                    }
+                  });
+            });
+      },
+      repeat);
+  double view = measure(
+      [&] {
+        for (auto [e1, t1, b1] : mem.view<Tf3f, AABox3f>()) {
+          for (auto [e2, t2, b2] : mem.view<Tf3f, AABox3f>()) {
+            if (e1 < e2 && overlap(t1, b1, t2, b2)) {
+              ++hits;
+            }
+          }
+        }
+      },
+      repeat);
+
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << cubes + 1 << " boxes, " << visits << " pair visits ("
+            << hits / (4 * repeat) << " overlaps)" << std::endl;
+  std::cout << std::setw(22) << "callback" << std::setw(14) << "ns/visit"
+            << std::setw(11) << "speedup" << std::endl;
+  auto print = [&](std::string const& name, double ns) {
+    std::cout << std::setw(22) << name << std::setw(14) << ns / visits
+              << std::setw(10) << function / ns << "x" << std::endl;
+  };
+  print("std::function Result", function);
+  print("lambda Result", result);
+  print("lambda void", plain);
+  print("view loop", view);
+  return 0;
+}
@@ -0,0 +1,125 @@
+#include <arty/core/geometry.hpp>
+#include <arty/core/scheduler.hpp>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+using namespace arty;
+
+struct Velocity {
+  Vec3f value;
+};
+
+template <int K>
+struct Channel {
+  Vec3f value;
+};
+
+/**
+ * @brief Independent work: each instance writes its own family
+ */
+template <int K>
+class ChannelSystem : public System {
+ public:
+  ChannelSystem() {
+    reads<Velocity>();
+    writes<Channel<K>>();
+    anyThread();
+  }
+
+  Result process(Ptr<Memory> const& mem) override {
+    for (auto [e, v, c] : mem->view<Velocity, Channel<K>>()) {
+      (void)e;
+      for (int i = 0; i < 8; ++i) {
+        c.value = Vec3f(std::sin(c.value.x() + v.value.x()),
+                        std::cos(c.value.y() + v.value.y() * K),
+                        std::sin(c.value.z() * v.value.z()));
+      }
+    }
+    return ok();
+  }
+};
+
+/**
+ * @brief Reads every channel, so it waits for all of them
+ */
+class SumSystem : public System {
+ public:
+  SumSystem() {
+    reads<Channel<0>, Channel<1>, Channel<2>, Channel<3>>();
+    writes<Velocity>();
+    anyThread();
+  }
+
+  Result process(Ptr<Memory> const& mem) override {
+    for (auto [e, v] : mem->view<Velocity>()) {
+      Vec3f sum = mem->get<Channel<0>>(e)->value +
+                  mem->get<Channel<1>>(e)->value +
+                  mem->get<Channel<2>>(e)->value +
+                  mem->get<Channel<3>>(e)->value;
+      v.value = sum * 0.25f;
+    }
+    return ok();
+  }
+};
+
+struct Run {
+  double ms;
+  float checksum;
+};
+
+Run run(std::size_t threads, std::size_t entities, int frames) {
+  Ptr<Memory> mem(new Memory);
+  for (std::size_t i = 0; i < entities; ++i) {
+    Entity e = mem->createEntity();
+    mem->write(e, Velocity{Vec3f::all(0.001f * static_cast<float>(i % 100))});
+    mem->write(e, Channel<0>{});
+    mem->write(e, Channel<1>{});
+    mem->write(e, Channel<2>{});
+    mem->write(e, Channel<3>{});
+  }
+  Scheduler scheduler(threads > 1 ? Ptr<ThreadPool>(new ThreadPool(threads))
+                                  : nullptr);
+  scheduler.build({Ptr<System>(new ChannelSystem<0>),
+                   Ptr<System>(new ChannelSystem<1>),
+                   Ptr<System>(new ChannelSystem<2>),
+                   Ptr<System>(new ChannelSystem<3>),
+                   Ptr<System>(new SumSystem)});
+  Ptr<InputManager> inputs(new InputManager);
+  auto start = std::chrono::steady_clock::now();
+  for (int f = 0; f < frames; ++f) {
+    scheduler.run(mem, inputs);
+  }
+  auto end = std::chrono::steady_clock::now();
+  float checksum = 0.f;
+  for (auto [e, v] : mem->view<Velocity>()) {
+    (void)e;
+    checksum += v.value.x() + v.value.y() + v.value.z();
+  }
+  return Run{std::chrono::duration<double, std::milli>(end - start).count() /
+                 frames,
+             checksum};
+}
+
+int main() {
+  std::size_t const entities = 100000;
+  int const frames = 10;
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << entities << " entities, 4 parallel systems + 1 join"
+            << std::endl;
+  std::cout << std::setw(8) << "threads" << std::setw(14) << "ms/frame"
+            << std::setw(11) << "speedup" << std::setw(14) << "checksum"
+            << std::endl;
+  double serial = 0.;
+  for (std::size_t threads : {1, 2, 4, 8}) {
+    Run r = run(threads, entities, frames);
+    if (threads == 1) {
+      serial = r.ms;
+    }
+    std::cout << std::setw(8) << threads << std::setw(14) << r.ms
+              << std::setw(10) << serial / r.ms << "x" << std::setw(14)
+              << r.checksum << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,74 @@
+#include <arty/impl/engine.hpp>
+#include <arty/impl/physics_system.hpp>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+using namespace arty;
+
+/**
+ * @brief Stacks of three cubes standing on a floor, apart from each other
+ */
+void makeStacks(Memory& mem, std::size_t cubes) {
+  auto side = static_cast<int>(std::ceil(std::sqrt(cubes / 3.)));
+  auto floor = mem.createEntity("floor");
+  mem.write(floor, AABox3f(Vec3f(), Vec3f(static_cast<float>(side),
+                                           static_cast<float>(side), 1.f)));
+  Particle fixed;
+  fixed.position = vector_t(0, 0, -1);
+  fixed.setMass(0);
+  mem.write(floor, fixed);
+  for (std::size_t n = 0; n < cubes; ++n) {
+    auto stack = static_cast<int>(n / 3);
+    auto e = mem.createEntity("cube");
+    mem.write(e, AABox3f(Vec3f(), Vec3f::all(0.4f)));
+    Particle p;
+    p.position = vector_t(2 * (stack % side) - side + 0.5,
+                          2 * (stack / side) - side + 0.5,
+                          0.4 + 0.8 * static_cast<double>(n % 3));
+    p.setMass(1);
+    mem.write(e, p);
+  }
+}
+
+/**
+ * @brief milliseconds per frame once the stacks have settled
+ */
+double settled(std::size_t cubes, bool sleeping, std::size_t frames) {
+  Ptr<Memory> mem(new Memory);
+  makeStacks(*mem, cubes);
+  Ptr<PhysicsSystem> physics(new PhysicsSystem);
+  if (!sleeping) {
+    physics->setSleeping(0., 0.);
+  }
+  Engine engine;
+  engine.setBoard(mem).setHeadless(60.).addSystem(physics);
+  engine.start();
+  // a second to settle, sleeping takes half of it
+  engine.run(60);
+  auto start = std::chrono::steady_clock::now();
+  engine.run(frames);
+  auto end = std::chrono::steady_clock::now();
+  engine.stop();
+  return std::chrono::duration<double, std::milli>(end - start).count() /
+         static_cast<double>(frames);
+}
+
+int main() {
+  std::size_t const frames = 60;
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "settled stacks, 30 physics steps per frame, ms per frame"
+            << std::endl;
+  std::cout << std::setw(8) << "cubes" << std::setw(10) << "awake"
+            << std::setw(10) << "asleep" << std::setw(10) << "gain"
+            << std::endl;
+  for (std::size_t cubes : {1000, 4000}) {
+    double awake = settled(cubes, false, frames);
+    double asleep = settled(cubes, true, frames);
+    std::cout << std::setw(8) << cubes << std::setw(10) << awake
+              << std::setw(10) << asleep << std::setw(9) << awake / asleep
+              << "x" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,234 @@
+#ifndef AABB_TREE_HPP
+#define AABB_TREE_HPP
+
+#include <arty/core/broadphase.hpp>
+#include <arty/core/geometry.hpp>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace arty {
+
+/**
+ * @brief Dynamic bounding volume hierarchy over the boxes of entities
+ *
+ * Leaves hold the box of an entity grown by a margin: as long as the box
+ * stays inside, moving it does not change the tree. A leaf is inserted next
+ * to the node that adds the least area to the tree (surface area
+ * heuristic), and the nodes above it are rotated when that makes the tree
+ * smaller, so queries only descend into the few nodes they cross.
+ * Queries report the entities whose grown box is hit, which is a superset
+ * of the boxes themselves: callers test them precisely.
+ *
+ * As an IBroadphase, the pairs are the ones of overlapping grown boxes.
+ * Between two sweeps, only the pairs of the leaves inserted again are
+ * searched.
+ */
+class AABBTree : public IBroadphase {
+ public:
+  /**
+   * @param margin added on each side of the boxes
+   */
+  explicit AABBTree(float margin = 0.1f) : _margin(margin) {}
+
+  /**
+   * @brief add the box of an entity, or move it
+   *
+   * An entity replaces the one that had the same index, if still there.
+   * @return whether the leaf was inserted again, the box being out of it
+   */
+  bool move(Entity const& entity, AABox3f const& box);
+
+  bool remove(Entity const& entity);
+
+  bool contains(Entity const& entity) const { return find(entity) != npos; }
+
+  /**
+   * @brief entities whose grown box overlaps the box, func(entity)
+   */
+  template <typename Func>
+  void query(AABox3f const& box, Func&& func) const {
+    Vec3f min = box.min();
+    Vec3f max = box.max();
+    visit(
+        [&](Node const& node) {
+          return node.min.x() <= max.x() && min.x() <= node.max.x() &&
+                 node.min.y() <= max.y() && min.y() <= node.max.y() &&
+                 node.min.z() <= max.z() && min.z() <= node.max.z();
+        },
+        [&](std::uint32_t leaf) { func(_nodes[leaf].entity); });
+  }
+
+  /**
+   * @brief entities whose grown box may be seen, func(entity)
+   */
+  template <typename Func>
+  void query(Frustum3f const& frustum, Func&& func) const {
+    visit(
+        [&](Node const& node) {
+          return frustum.intersect(AABox3f((node.min + node.max) * 0.5f,
+                                           (node.max - node.min) * 0.5f));
+        },
+        [&](std::uint32_t leaf) { func(_nodes[leaf].entity); });
+  }
+
+  /**
+   * @brief entities whose grown box the ray crosses, nearest nodes first
+   *
+   * The ray starts at the origin of the line and goes along its direction,
+   * up to origin + direction * length. func(entity) returns the length to
+   * search up to: the one of a hit to look for closer ones only, or
+   * infinity to go on.
+   */
+  template <typename Func>
+  void raycast(Line3f const& ray, Func&& func,
+               float length = std::numeric_limits<float>::infinity()) const {
+    if (_root == npos) {
+      return;
+    }
+    Vec3f origin = ray.origin();
+    Vec3f inverse = ray.direction().apply([](float d) { return 1.f / d; });
+    // nodes with the distance at which the ray enters them
+    std::vector<std::pair<std::uint32_t, float>> stack;
+    float enter = 0.f;
+    if (crosses(origin, inverse, _root, length, enter)) {
+      stack.emplace_back(_root, enter);
+    }
+    while (!stack.empty()) {
+      auto [index, at] = stack.back();
+      stack.pop_back();
+      if (at > length) {
+        continue;
+      }
+      Node const& node = _nodes[index];
+      if (node.leaf()) {
+        length = std::min(length, static_cast<float>(func(node.entity)));
+        continue;
+      }
+      float enterLeft = 0.f;
+      float enterRight = 0.f;
+      bool left = crosses(origin, inverse, node.left, length, enterLeft);
+      bool right = crosses(origin, inverse, node.right, length, enterRight);
+      // the nearest one is on top
+      if (left && right && enterLeft > enterRight) {
+        stack.emplace_back(node.left, enterLeft);
+        stack.emplace_back(node.right, enterRight);
+        continue;
+      }
+      if (right) {
+        stack.emplace_back(node.right, enterRight);
+      }
+      if (left) {
+        stack.emplace_back(node.left, enterLeft);
+      }
+    }
+  }
+
+  /**
+   * @brief box of the leaf of an entity, with the margin
+   */
+  AABox3f fattened(Entity const& entity) const;
+
+  // IBroadphase
+  void update(Entity const& entity, AABox3f const& box) override {
+    move(entity, box);
+  }
+  void sweep() override;
+  std::vector<EntityPair> const& pairs() const override { return _pairs; }
+  std::size_t size() const override { return _size; }
+  void clear() override;
+
+  /**
+   * @brief number of levels below the root, 0 for a single leaf
+   */
+  int height() const { return _root == npos ? 0 : _nodes[_root].height; }
+
+  /**
+   * @brief sum of the areas of the inner nodes, what insertions minimize
+   */
+  float cost() const;
+
+  /**
+   * @brief whether links, boxes and heights are consistent, for tests
+   */
+  bool valid() const;
+
+ private:
+  static constexpr std::uint32_t npos = UINT32_MAX;
+
+  struct Node {
+    Vec3f min;
+    Vec3f max;
+    std::uint32_t parent = npos;
+    std::uint32_t left = npos;
+    std::uint32_t right = npos;
+    // 0 for leaves, -1 once free
+    int height = -1;
+    Entity entity;
+    // sweep the leaf was last updated for
+    std::uint64_t round = 0;
+    // its pairs are searched again by the next sweep
+    bool dirty = false;
+
+    bool leaf() const { return left == npos; }
+  };
+
+  // walks the nodes that pass the test, func(leaf) on the leaves
+  template <typename Test, typename Func>
+  void visit(Test&& test, Func&& func) const {
+    if (_root == npos) {
+      return;
+    }
+    std::vector<std::uint32_t> stack{_root};
+    while (!stack.empty()) {
+      std::uint32_t index = stack.back();
+      stack.pop_back();
+      Node const& node = _nodes[index];
+      if (!test(node)) {
+        continue;
+      }
+      if (node.leaf()) {
+        func(index);
+      } else {
+        stack.push_back(node.left);
+        stack.push_back(node.right);
+      }
+    }
+  }
+
+  bool crosses(Vec3f const& origin, Vec3f const& inverse, std::uint32_t node,
+               float length, float& enter) const;
+  std::uint32_t find(Entity const& entity) const;
+  std::uint32_t allocate();
+  void release(std::uint32_t node);
+  void insertLeaf(std::uint32_t leaf);
+  void removeLeaf(std::uint32_t leaf);
+  void erase(std::uint32_t leaf);
+  // fix the boxes and heights, and rotate, from a node up to the root
+  void refitUp(std::uint32_t node);
+  void refit(std::uint32_t node);
+  void rotate(std::uint32_t node);
+  // exchange a child of a node with a grandchild under its other child
+  void swap(std::uint32_t child, std::uint32_t grandchild);
+  void touch(std::uint32_t leaf);
+  float area(std::uint32_t a, std::uint32_t b) const;
+  float area(std::uint32_t node) const;
+
+  float _margin;
+  std::vector<Node> _nodes;
+  std::vector<std::uint32_t> _free;
+  std::uint32_t _root = npos;
+  std::size_t _size = 0;
+  // leaf of each entity, by Entity::index
+  std::vector<std::uint32_t> _sparse;
+  std::uint64_t _round = 1;
+  std::vector<std::uint32_t> _dirty;
+  std::vector<EntityPair> _pairs;
+  // the leaves of each pair
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> _leaves;
+};
+
+}  // namespace arty
+
+#endif  // AABB_TREE_HPP
@@ -0,0 +1,148 @@
+#ifndef BROADPHASE_HPP
+#define BROADPHASE_HPP
+
+#include <arty/core/entity.hpp>
+#include <arty/core/geometry.hpp>
+#include <arty/core/result.hpp>
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace arty {
+
+class ThreadPool;
+
+/**
+ * @brief Two boxes that overlap, first < second
+ */
+using EntityPair = std::pair<Entity, Entity>;
+
+/**
+ * @brief Finds the pairs of boxes that may overlap, so that only those are
+ * tested precisely
+ *
+ * Every box must be updated before each sweep, even if it did not move: the
+ * ones that were not are removed by the sweep.
+ */
+class IBroadphase {
+ public:
+  virtual ~IBroadphase() = default;
+
+  /**
+   * @brief set the box of an entity, in world coordinates
+   */
+  virtual void update(Entity const& entity, AABox3f const& box) = 0;
+
+  /**
+   * @brief remove the boxes that were not updated and find the pairs
+   */
+  virtual void sweep() = 0;
+
+  /**
+   * @brief pairs as of the last sweep, in no particular order
+   *
+   * Every pair of overlapping boxes is in, a broadphase may add pairs of
+   * boxes that are only close.
+   */
+  virtual std::vector<EntityPair> const& pairs() const = 0;
+
+  virtual std::size_t size() const = 0;
+
+  virtual void clear() = 0;
+
+  /**
+   * @brief threads to sweep with, for the broadphases that can
+   */
+  virtual void setThreadPool(Ptr<ThreadPool> const& /*pool*/) {}
+};
+
+/**
+ * @brief Incremental sweep and prune over the boxes of entities
+ *
+ * The bounds of the boxes are kept sorted on the three axes. Between two
+ * sweeps boxes move little, so an insertion sort puts them back in order
+ * in close to linear time. Each swap of a lower bound with an upper one
+ * starts or ends an overlap on that axis: only those pairs are tested, and
+ * the overlapping pairs are maintained from one sweep to the next instead
+ * of being searched again.
+ * New boxes are inserted at their place and tested against every other
+ * one, unless there are many: then everything is sorted again from scratch.
+ * Bounds are closed: boxes that touch overlap, as with AABox::intersection.
+ * They must be finite.
+ */
+class SweepAndPrune : public IBroadphase {
+ public:
+  void update(Entity const& entity, AABox3f const& box) override;
+
+  /**
+   * @brief sort the bounds and update the overlapping pairs
+   */
+  void sweep() override;
+
+  /**
+   * @brief exactly the overlapping pairs
+   */
+  std::vector<EntityPair> const& pairs() const override { return _pairs; }
+
+  std::size_t size() const override { return _proxies.size() - _free.size(); }
+
+  void clear() override;
+
+ private:
+  static constexpr std::uint32_t npos = UINT32_MAX;
+
+  struct Proxy {
+    Entity entity;
+    Vec3f min;
+    Vec3f max;
+    // sweep it was last updated for, 0 once free
+    std::uint64_t round = 0;
+    // position of its bounds in the axes, lower then upper, once placed
+    std::array<std::uint32_t, 6> at;
+    bool placed = false;
+  };
+
+  // the proxy index shifted left by one, the low bit set for upper bounds
+  struct Bound {
+    float value;
+    std::uint32_t data;
+  };
+
+  static bool before(Bound const& a, Bound const& b) {
+    // at equal values lower bounds come first, so touching boxes overlap
+    return a.value < b.value ||
+           (a.value == b.value && (a.data & 1) < (b.data & 1));
+  }
+
+  bool alive(std::uint32_t proxy) const {
+    return _proxies[proxy].round == _round;
+  }
+  bool overlap(std::uint32_t a, std::uint32_t b) const;
+  void store(std::uint32_t proxy);
+  void index(std::size_t axis);
+  void sort(std::size_t axis);
+  void insert(std::uint32_t proxy);
+  void rebuild();
+  void add(std::uint32_t a, std::uint32_t b);
+  void drop(std::uint32_t a, std::uint32_t b);
+  // drop the pair at this index of _pairs
+  void erase(std::size_t index);
+
+  std::vector<Proxy> _proxies;
+  std::vector<std::uint32_t> _free;
+  // proxy of each entity, by Entity::index
+  std::vector<std::uint32_t> _sparse;
+  // updated for the first time, their bounds are not in the axes yet
+  std::vector<std::uint32_t> _added;
+  std::array<std::vector<Bound>, 3> _bounds;
+  std::uint64_t _round = 1;
+  std::vector<EntityPair> _pairs;
+  // the two proxies of each pair, and its index in _pairs
+  std::vector<std::uint64_t> _keys;
+  std::unordered_map<std::uint64_t, std::size_t> _indices;
+};
+
+}  // namespace arty
+
+#endif  // BROADPHASE_HPP
@@ -0,0 +1,32 @@
+#ifndef CLOCK_HPP
+#define CLOCK_HPP
+
+#include <cstddef>
+
+namespace arty {
+
+/**
+ * @brief Simulated time, stored as a Memory resource by the Engine
+ *
+ * Fixed step systems advance the simulation by exactly step seconds per
+ * call, as many times per frame as the elapsed time requires. What is left
+ * in the accumulator is given as alpha, the fraction of a step the rendering
+ * is ahead of the last simulated state.
+ */
+struct SimulationClock {
+  // simulated seconds per fixed step
+  double step = 1. / 1800.;
+  // simulated seconds since the start
+  double time = 0.;
+  // fixed steps run during the current frame, and the one running
+  std::size_t frameSteps = 0;
+  std::size_t stepIndex = 0;
+  // in [0, 1), to interpolate between the last two simulated states
+  double alpha = 0.;
+
+  bool lastStep() const { return stepIndex + 1 >= frameSteps; }
+};
+
+}  // namespace arty
+
+#endif  // CLOCK_HPP
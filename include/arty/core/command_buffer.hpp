@@ -0,0 +1,64 @@
+#ifndef COMMAND_BUFFER_HPP
+#define COMMAND_BUFFER_HPP
+
+#include <arty/core/memory.hpp>
+#include <functional>
+#include <vector>
+
+namespace arty {
+
+/**
+ * @brief Structural changes recorded now and applied to a Memory later
+ *
+ * A system iterating a family records the components it adds and the
+ * entities it kills instead of applying them in the middle of the walk. The
+ * buffer is played back, in order, at a sync point: the Engine flushes the
+ * buffer of every system right after its process.
+ * Entities are still created directly with Memory::createEntity, it only
+ * touches the entity table and is safe while iterating.
+ */
+class CommandBuffer {
+ public:
+  template <typename T>
+  void write(Entity const& entity, T const& val) {
+    _commands.push_back(
+        Command{[entity, val](Memory& mem) { mem.write(entity, val); },
+                Entity()});
+  }
+
+  template <typename T>
+  void remove(Entity const& entity) {
+    _commands.push_back(Command{
+        [entity](Memory& mem) { mem.remove<T>(entity); }, Entity()});
+  }
+
+  /**
+   * @brief kill the entity and every component it has
+   */
+  void remove(Entity const& entity) {
+    _commands.push_back(Command{nullptr, entity});
+  }
+
+  /**
+   * @brief apply every recorded command, in order, then empty the buffer
+   *
+   * Consecutive entity removals are applied with a single Memory::removeAll.
+   */
+  void flush(Memory& mem);
+
+  void clear() { _commands.clear(); }
+  bool empty() const { return _commands.empty(); }
+  std::size_t size() const { return _commands.size(); }
+
+ private:
+  struct Command {
+    std::function<void(Memory&)> apply;
+    Entity removed;  // entity removal when there is nothing to apply
+  };
+
+  std::vector<Command> _commands;
+};
+
+}  // namespace arty
+
+#endif  // COMMAND_BUFFER_HPP
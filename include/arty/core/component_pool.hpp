@@ -0,0 +1,444 @@
+#ifndef COMPONENT_POOL_HPP
+#define COMPONENT_POOL_HPP
+
+#include <algorithm>
+#include <arty/core/entity.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace arty {
+
+/**
+ * @brief Logical time of the Memory, used to stamp component changes
+ */
+using Tick = std::uint64_t;
+
+/**
+ * @brief Type erased interface over a ComponentPool
+ *
+ * Lets the Memory run the operations that do not need the component type,
+ * like removing an entity from every family
+ */
+class IComponentPool {
+ public:
+  /**
+   * @brief told when an entity gains (true) or loses (false) the component
+   */
+  using Membership = std::function<void(Entity const&, bool)>;
+
+  virtual ~IComponentPool() = default;
+
+  /**
+   * @brief called on every insertion and removal once really applied,
+   * deferred ones included when the pool is unlocked
+   */
+  virtual void observe(Membership membership) = 0;
+
+  virtual bool contains(Entity const& entity) const = 0;
+  virtual bool remove(Entity const& entity) = 0;
+  virtual std::size_t removeAll(std::vector<Entity> const& entities) = 0;
+  virtual void clear() = 0;
+  virtual std::size_t size() const = 0;
+  virtual std::vector<Entity> const& entities() const = 0;
+  virtual void lock() = 0;
+  virtual void unlock() = 0;
+
+  /**
+   * @brief tick stamped on the following changes
+   */
+  virtual void setTick(Tick tick) = 0;
+  virtual Tick changedTick(Entity const& entity) const = 0;
+  virtual Tick addedTick(Entity const& entity) const = 0;
+  /**
+   * @brief last tick anything was written, added or removed, 0 if never
+   */
+  virtual Tick modifiedTick() const = 0;
+  /**
+   * @brief removal log, in tick order
+   */
+  virtual std::vector<std::pair<Entity, Tick>> const& removed() const = 0;
+  /**
+   * @brief drop the removals logged at or before tick
+   */
+  virtual void forget(Tick tick) = 0;
+
+  /**
+   * @brief empty pool of the same type
+   */
+  virtual std::unique_ptr<IComponentPool> make() const = 0;
+
+  /**
+   * @brief overwrite dst, a pool of the same type, with this one
+   *
+   * dst keeps its buffers: copying into it again does not allocate once they
+   * are large enough. This pool must not be locked.
+   */
+  virtual void copyTo(IComponentPool& dst) const = 0;
+};
+
+/**
+ * @brief Scoped lock of a pool, held while a family is iterated
+ */
+class PoolGuard {
+ public:
+  PoolGuard(IComponentPool& pool) : _pool(pool) { _pool.lock(); }
+  ~PoolGuard() { _pool.unlock(); }
+  PoolGuard(PoolGuard const&) = delete;
+  PoolGuard& operator=(PoolGuard const&) = delete;
+
+ private:
+  IComponentPool& _pool;
+};
+
+/**
+ * @brief Dense storage for every component of type T
+ *
+ * Components are packed in a contiguous array, with the owning entities in a
+ * parallel array (structure of arrays): iterating a family is a linear walk
+ * over both arrays.
+ * A sparse array indexed by entity index gives the slot of an entity in the
+ * dense arrays, so lookup, insertion and removal are constant time. The
+ * stored handle is compared on lookup: a stale handle whose slot was
+ * recycled finds nothing.
+ * Removal swaps the last element into the freed slot, therefore the dense
+ * order is not the entity order.
+ *
+ * Every slot also keeps the tick it was added and last written at, in two
+ * more parallel arrays, and removals are logged with their tick. In place
+ * modifications through find() are not seen, call touch() after them.
+ *
+ * While the pool is locked (ie someone iterates it) the dense arrays never
+ * move: overwriting an existing component is done in place, but insertions,
+ * removals and clear are queued and applied, in order, when the last lock is
+ * released. Until then find() keeps returning the current values, while
+ * the return values of write and remove describe the queue.
+ */
+template <typename T>
+class ComponentPool : public IComponentPool {
+ public:
+  using value_type = T;
+  static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+  void observe(Membership membership) override {
+    _membership = std::move(membership);
+  }
+
+  bool contains(Entity const& entity) const override {
+    return slot(entity) != npos;
+  }
+
+  T* find(Entity const& entity) {
+    std::size_t s = slot(entity);
+    return s == npos ? nullptr : &_components[s];
+  }
+
+  T const* find(Entity const& entity) const {
+    std::size_t s = slot(entity);
+    return s == npos ? nullptr : &_components[s];
+  }
+
+  /**
+   * @return true if the entity did not have the component
+   */
+  bool write(Entity const& entity, T const& val) {
+    std::size_t s = slot(entity);
+    if (_locks > 0 && (s == npos || deferred(entity))) {
+      bool added = !queued(entity, s);
+      defer(WRITE, entity, val);
+      return added;
+    }
+    _modified.store(_tick, std::memory_order_relaxed);
+    if (s != npos) {
+      _components[s] = val;
+      _changed[s] = _tick;
+      return false;
+    }
+    std::size_t index = entity.index();
+    if (index >= _sparse.size()) {
+      _sparse.resize(index + 1, npos);
+    }
+    if (_sparse[index] != npos) {
+      // a previous owner of the index is still there
+      Entity previous = _entities[_sparse[index]];
+      remove(previous);
+    }
+    _sparse[index] = _entities.size();
+    _entities.push_back(entity);
+    _components.push_back(val);
+    _added.push_back(_tick);
+    _changed.push_back(_tick);
+    if (_membership) {
+      _membership(entity, true);
+    }
+    return true;
+  }
+
+  /**
+   * @brief mark the component of the entity as changed now
+   */
+  void touch(Entity const& entity) {
+    std::size_t s = slot(entity);
+    if (s != npos) {
+      _changed[s] = _tick;
+      // chunks of parallelProcess touch the pool concurrently, reading first
+      // keeps them from fighting over the cache line
+      if (_modified.load(std::memory_order_relaxed) != _tick) {
+        _modified.store(_tick, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool remove(Entity const& entity) override {
+    std::size_t s = slot(entity);
+    if (_locks > 0) {
+      bool removed = queued(entity, s);
+      defer(REMOVE, entity, std::nullopt);
+      return removed;
+    }
+    if (s == npos) {
+      return false;
+    }
+    // entity may alias an element of the dense array, keep its index
+    std::size_t index = entity.index();
+    std::size_t last = _entities.size() - 1;
+    _removed.emplace_back(_entities[s], _tick);
+    _modified.store(_tick, std::memory_order_relaxed);
+    if (s != last) {
+      _entities[s] = std::move(_entities[last]);
+      _components[s] = std::move(_components[last]);
+      _added[s] = _added[last];
+      _changed[s] = _changed[last];
+      _sparse[_entities[s].index()] = s;
+    }
+    _sparse[index] = npos;
+    _entities.pop_back();
+    _components.pop_back();
+    _added.pop_back();
+    _changed.pop_back();
+    if (_membership) {
+      _membership(entity, false);
+    }
+    return true;
+  }
+
+  /**
+   * @brief remove a batch of entities
+   * @return the number of components removed
+   *
+   * Large batches are removed with a single compaction pass, which keeps the
+   * order of the remaining components. Small ones fall back to remove().
+   */
+  std::size_t removeAll(std::vector<Entity> const& entities) override {
+    std::size_t count = 0;
+    if (_locks > 0 || entities.size() * 4 < _entities.size()) {
+      for (auto const& e : entities) {
+        count += remove(e) ? 1 : 0;
+      }
+      return count;
+    }
+    for (auto const& e : entities) {
+      if (slot(e) != npos) {
+        _sparse[e.index()] = npos;
+        _removed.emplace_back(e, _tick);
+        ++count;
+        if (_membership) {
+          _membership(e, false);
+        }
+      }
+    }
+    if (count == 0) {
+      return 0;
+    }
+    _modified.store(_tick, std::memory_order_relaxed);
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < _entities.size(); ++i) {
+      if (_sparse[_entities[i].index()] != i) {
+        continue;  // removed above
+      }
+      if (kept != i) {
+        _entities[kept] = std::move(_entities[i]);
+        _components[kept] = std::move(_components[i]);
+        _added[kept] = _added[i];
+        _changed[kept] = _changed[i];
+        _sparse[_entities[kept].index()] = kept;
+      }
+      ++kept;
+    }
+    _entities.erase(_entities.begin() + kept, _entities.end());
+    _components.erase(_components.begin() + kept, _components.end());
+    _added.resize(kept);
+    _changed.resize(kept);
+    return count;
+  }
+
+  void clear() override {
+    if (_locks > 0) {
+      defer(CLEAR, Entity(), std::nullopt);
+      return;
+    }
+    for (auto const& e : _entities) {
+      _removed.emplace_back(e, _tick);
+      if (_membership) {
+        _membership(e, false);
+      }
+    }
+    if (!_entities.empty()) {
+      _modified.store(_tick, std::memory_order_relaxed);
+    }
+    _sparse.clear();
+    _entities.clear();
+    _components.clear();
+    _added.clear();
+    _changed.clear();
+  }
+
+  std::size_t size() const override { return _entities.size(); }
+
+  void lock() override { ++_locks; }
+
+  void unlock() override {
+    if (--_locks == 0 && !_pending.empty()) {
+      flush();
+    }
+  }
+
+  void setTick(Tick tick) override { _tick = tick; }
+
+  Tick changedTick(Entity const& entity) const override {
+    std::size_t s = slot(entity);
+    return s == npos ? 0 : _changed[s];
+  }
+
+  Tick addedTick(Entity const& entity) const override {
+    std::size_t s = slot(entity);
+    return s == npos ? 0 : _added[s];
+  }
+
+  Tick modifiedTick() const override {
+    return _modified.load(std::memory_order_relaxed);
+  }
+
+  std::vector<std::pair<Entity, Tick>> const& removed() const override {
+    return _removed;
+  }
+
+  void forget(Tick tick) override {
+    auto end = std::find_if(_removed.begin(), _removed.end(),
+                            [tick](auto const& r) { return r.second > tick; });
+    _removed.erase(_removed.begin(), end);
+  }
+
+  std::unique_ptr<IComponentPool> make() const override {
+    return std::make_unique<ComponentPool<T>>();
+  }
+
+  void copyTo(IComponentPool& dst) const override {
+    auto& other = static_cast<ComponentPool<T>&>(dst);
+    other._sparse = _sparse;
+    other._entities = _entities;
+    other._components = _components;
+    other._added = _added;
+    other._changed = _changed;
+    other._removed = _removed;
+    other._tick = _tick;
+    other._modified.store(modifiedTick(), std::memory_order_relaxed);
+  }
+
+  std::vector<Entity> const& entities() const override { return _entities; }
+  std::vector<T> const& components() const { return _components; }
+  std::vector<T>& components() { return _components; }
+  std::vector<Tick> const& changes() const { return _changed; }
+
+ private:
+  enum Operation { WRITE, REMOVE, CLEAR };
+
+  struct Pending {
+    Operation op;
+    Entity entity;
+    std::optional<T> value;
+  };
+
+  bool deferred(Entity const& entity) const {
+    return _cleared || _deferred.count(entity.id()) > 0;
+  }
+
+  // whether the entity has the component once the queue is applied
+  bool queued(Entity const& entity, std::size_t s) const {
+    auto it = _deferred.find(entity.id());
+    if (it != _deferred.end()) {
+      return it->second;
+    }
+    return !_cleared && s != npos;
+  }
+
+  void defer(Operation op, Entity const& entity, std::optional<T> value) {
+    if (op == CLEAR) {
+      _cleared = true;
+      _deferred.clear();
+    } else {
+      _deferred[entity.id()] = op == WRITE;
+    }
+    _pending.push_back(Pending{op, entity, std::move(value)});
+  }
+
+  void flush() {
+    std::vector<Pending> pending;
+    std::swap(pending, _pending);
+    _deferred.clear();
+    _cleared = false;
+    for (auto& p : pending) {
+      switch (p.op) {
+        case WRITE:
+          write(p.entity, *p.value);
+          break;
+        case REMOVE:
+          remove(p.entity);
+          break;
+        case CLEAR:
+          clear();
+          break;
+      }
+    }
+  }
+
+  std::size_t slot(Entity const& entity) const {
+    std::size_t index = entity.index();
+    if (index >= _sparse.size()) {
+      return npos;
+    }
+    std::size_t s = _sparse[index];
+    if (s == npos || _entities[s] != entity) {
+      return npos;
+    }
+    return s;
+  }
+
+  std::vector<std::size_t> _sparse;
+  std::vector<Entity> _entities;
+  std::vector<T> _components;
+  std::vector<Tick> _added;
+  std::vector<Tick> _changed;
+  std::vector<std::pair<Entity, Tick>> _removed;
+  Tick _tick = 0;
+  // written by concurrent touches, see Memory::parallelProcess
+  std::atomic<Tick> _modified{0};
+  // concurrent readers lock it at the same time
+  std::atomic<int> _locks{0};
+  std::vector<Pending> _pending;
+  // entities with queued operations, and whether they end up in the pool
+  std::unordered_map<uint64_t, bool> _deferred;
+  bool _cleared = false;
+  Membership _membership;
+};
+
+}  // namespace arty
+
+#endif  // COMPONENT_POOL_HPP
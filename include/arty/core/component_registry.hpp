@@ -0,0 +1,69 @@
+#ifndef COMPONENT_REGISTRY_HPP
+#define COMPONENT_REGISTRY_HPP
+
+#include <bitset>
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+
+namespace arty {
+
+using ComponentId = std::size_t;
+
+/**
+ * @brief Maximum number of component types
+ */
+static constexpr std::size_t MAX_COMPONENTS = 128;
+
+/**
+ * @brief Set of component types, one bit per ComponentId
+ */
+using Signature = std::bitset<MAX_COMPONENTS>;
+
+/**
+ * @brief readable name of a type, from typeid(T).name()
+ */
+std::string demangle(char const* mangled);
+
+/**
+ * @brief Gives each component type a dense integer id
+ *
+ * Ids are attributed on first use, starting from 0, so the Memory can find a
+ * family with a plain index into a flat table. There can be at most
+ * MAX_COMPONENTS types, adding one more throws std::length_error.
+ * Types are compared by type_info, so a plugin defining a component gets the
+ * same id every time it is loaded.
+ * The type name is kept alongside for diagnostics only.
+ */
+class ComponentRegistry {
+ public:
+  template <typename T>
+  static ComponentId id() {
+    return Type<std::remove_cv_t<std::remove_reference_t<T>>>::id();
+  }
+
+  template <typename T>
+  static std::string const& name() {
+    return name(id<T>());
+  }
+
+  static std::string const& name(ComponentId id);
+
+  static std::size_t size();
+
+ private:
+  template <typename T>
+  struct Type {
+    static ComponentId id() {
+      static const ComponentId value = add(typeid(T));
+      return value;
+    }
+  };
+
+  static ComponentId add(std::type_info const& type);
+};
+
+}  // namespace arty
+
+#endif  // COMPONENT_REGISTRY_HPP
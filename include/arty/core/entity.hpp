@@ -0,0 +1,61 @@
+#ifndef ENTITY_HPP
+#define ENTITY_HPP
+
+#include <cstdint>
+#include <functional>
+
+namespace arty {
+
+/**
+ * @brief Handle on an entity of a Memory
+ *
+ * 64 bits: the low half is the slot index, the high half the generation of
+ * that slot. When an entity is removed its slot is recycled with a new
+ * generation, so old handles can be told apart from the new owner.
+ * Index 0 is never allocated: the default handle is the invalid entity.
+ * Names are not carried by the handle, see Memory::name.
+ */
+struct Entity {
+ public:
+  using id_type = uint64_t;
+  using index_type = uint32_t;
+  using generation_type = uint32_t;
+
+ private:
+  id_type _id;
+
+ public:
+  Entity() : _id(0) {}
+  Entity(index_type index, generation_type generation)
+      : _id(static_cast<id_type>(generation) << 32 | index) {}
+
+  bool operator<(Entity const& rhs) const { return _id < rhs._id; }
+  bool operator>(Entity const& rhs) const { return _id > rhs._id; }
+  bool operator==(Entity const& rhs) const { return _id == rhs._id; }
+  bool operator!=(Entity const& rhs) const { return !(*this == rhs); }
+  bool operator>=(Entity const& rhs) const { return !(*this < rhs); }
+  bool operator<=(Entity const& rhs) const { return !(*this > rhs); }
+  bool isValid() const { return index() != 0; }
+  explicit operator bool() const { return isValid(); }
+
+  id_type id() const { return _id; }
+  index_type index() const { return static_cast<index_type>(_id); }
+  generation_type generation() const {
+    return static_cast<generation_type>(_id >> 32);
+  }
+};
+
+}  // namespace arty
+namespace std {
+
+template <>
+class hash<arty::Entity> {
+ public:
+  size_t operator()(arty::Entity const& s) const {
+    return std::hash<uint64_t>()(s.id());
+  }
+};
+
+}  // namespace std
+
+#endif  // ENTITY_HPP
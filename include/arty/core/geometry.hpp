@@ -2,6 +2,7 @@
 #define GEOMETRY_HPP
 
 #include <arty/core/math.hpp>
+#include <array>
 #include <vector>
 
 namespace arty {
@@ -396,6 +397,62 @@ class Polygon {
 };
 using Polygon3f = Polygon<float, 3>;
 
+/**
+ * @brief The volume a camera sees, between six planes
+ */
+template <typename T>
+class Frustum {
+ public:
+  using vector_type = Vec3<T>;
+  using box_type = AABox<T, 3>;
+
+  Frustum() = default;
+
+  /**
+   * @brief volume of a projection * view matrix
+   *
+   * Points p for which (x, y, z, w) = m * p is such that -w <= x, y, z <= w.
+   */
+  explicit Frustum(Mat<T, 4, 4> const& m) {
+    for (int axis = 0; axis < 3; ++axis) {
+      for (int side = 0; side < 2; ++side) {
+        T sign = side ? T(-1) : T(1);
+        auto& normal = _normals[2 * axis + side];
+        for (int j = 0; j < 3; ++j) {
+          normal[j] = m(3, j) + sign * m(axis, j);
+        }
+        _offsets[2 * axis + side] = m(3, 3) + sign * m(axis, 3);
+      }
+    }
+  }
+
+  /**
+   * @brief false only if the box is out of the volume
+   *
+   * A box outside of it, but not entirely behind one of the planes, may
+   * still be said to intersect it.
+   */
+  bool intersect(box_type const& box) const {
+    for (std::size_t i = 0; i < _normals.size(); ++i) {
+      vector_type const& n = _normals[i];
+      // the corner of the box the furthest along the normal
+      T reach = std::abs(n.x()) * box.halfLength().x() +
+                std::abs(n.y()) * box.halfLength().y() +
+                std::abs(n.z()) * box.halfLength().z();
+      if (n.dot(box.center()) + _offsets[i] + reach < T(0)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  // inside is where dot(normal, p) + offset >= 0
+  std::array<vector_type, 6> _normals;
+  std::array<T, 6> _offsets;
+};
+using Frustum3f = Frustum<float>;
+
 namespace Geo {
 // CONTAINS
 template <typename T, int D>
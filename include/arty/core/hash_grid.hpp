@@ -0,0 +1,121 @@
+#ifndef HASH_GRID_HPP
+#define HASH_GRID_HPP
+
+#include <arty/core/broadphase.hpp>
+#include <arty/core/thread_pool.hpp>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace arty {
+
+/**
+ * @brief Broadphase on a uniform grid of cubic cells, hashed in a table
+ *
+ * Made for many boxes of about the same size: with cells a bit larger than
+ * the boxes, each box is in a few cells and each cell holds a few boxes.
+ * The grid is built again at each sweep, it costs the same whether boxes
+ * move or not. Its storage is kept from one sweep to the next: once it
+ * has grown to the size of the scene, sweeping does not allocate.
+ * Two boxes in the same cell are tested, a pair is reported by the cell of
+ * the lower corner of its overlap only. Cells are tested in parallel on
+ * the thread pool, if any. Boxes covering too many cells are set apart and
+ * tested against every other one.
+ * Bounds are closed, as with SweepAndPrune. They must be finite.
+ */
+class SpatialHashGrid : public IBroadphase {
+ public:
+  /**
+   * @param cellSize side of the cells, about the size of the largest boxes
+   */
+  explicit SpatialHashGrid(float cellSize = 1.f);
+
+  void update(Entity const& entity, AABox3f const& box) override;
+
+  /**
+   * @brief fill the cells and test the boxes sharing one
+   */
+  void sweep() override;
+
+  /**
+   * @brief exactly the overlapping pairs
+   */
+  std::vector<EntityPair> const& pairs() const override { return _pairs; }
+
+  std::size_t size() const override { return _proxies.size() - _free.size(); }
+
+  void clear() override;
+
+  void setThreadPool(Ptr<ThreadPool> const& pool) override { _pool = pool; }
+
+  float cellSize() const { return _cellSize; }
+
+  /**
+   * @brief number of cells holding a box, as of the last sweep
+   */
+  std::size_t cells() const { return _used.size(); }
+
+ private:
+  static constexpr std::uint32_t npos = UINT32_MAX;
+  // boxes covering more cells are tested against every other one
+  static constexpr std::int64_t LARGE = 64;
+
+  struct Proxy {
+    Entity entity;
+    Vec3f min;
+    Vec3f max;
+    // sweep it was last updated for, 0 once free
+    std::uint64_t round = 0;
+    // range of cells it covers, as of the last sweep
+    std::array<std::int32_t, 3> lower;
+    std::array<std::int32_t, 3> upper;
+    // covers too many cells, see LARGE
+    bool large = false;
+  };
+
+  // open addressing, a slot is empty unless filled during this sweep
+  struct Slot {
+    std::uint64_t key;
+    std::uint64_t round = 0;
+    // boxes of the cell in _entries
+    std::uint32_t start;
+    std::uint32_t count;
+  };
+
+  std::int32_t cell(float value) const;
+  bool overlap(std::uint32_t a, std::uint32_t b) const;
+  // the coordinates of a cell on 21 bits each: cells a million apart
+  // share a slot, which only costs tests
+  static std::uint64_t key(std::int32_t x, std::int32_t y, std::int32_t z);
+  // slot of a cell, added if new; npos once the table is too full
+  std::uint32_t slot(std::uint64_t key);
+  // fill the table, false if it is too small
+  bool fill();
+  void collect(std::size_t chunk, std::size_t chunks);
+
+  float _cellSize;
+  float _inverse;
+  std::vector<Proxy> _proxies;
+  std::vector<std::uint32_t> _free;
+  // proxy of each entity, by Entity::index
+  std::vector<std::uint32_t> _sparse;
+  std::uint64_t _round = 1;
+  std::vector<Slot> _table;
+  // 64 - log2 of the size of the table
+  int _shift = 64 - 10;
+  // slots filled during this sweep
+  std::vector<std::uint32_t> _used;
+  // slot of each cell of each proxy, in proxy order
+  std::vector<std::uint32_t> _cells;
+  // proxies of each cell, one after the other
+  std::vector<std::uint32_t> _entries;
+  std::vector<std::uint32_t> _large;
+  // pairs found by each chunk of cells
+  std::vector<std::vector<EntityPair>> _found;
+  std::vector<EntityPair> _pairs;
+  Ptr<ThreadPool> _pool;
+};
+
+}  // namespace arty
+
+#endif  // HASH_GRID_HPP
@@ -0,0 +1,48 @@
+#ifndef HEADLESS_WINDOW_HPP
+#define HEADLESS_WINDOW_HPP
+
+#include <arty/core/window.hpp>
+#include <chrono>
+
+namespace arty {
+
+/**
+ * @brief Window that shows nothing, for servers, tests and batch runs
+ *
+ * It is always ready, its time is the wall clock since init and it stays
+ * open until close().
+ */
+class HeadlessWindow : public Window {
+ public:
+  HeadlessWindow(WindowMode mode, std::string const name)
+      : Window(mode, name), _open(false) {}
+  HeadlessWindow() : HeadlessWindow(WindowMode::Windowed(1280, 720), "") {}
+
+  // Window interface
+ public:
+  Result init() override;
+
+  void clear() override {}
+
+  void refresh() override {}
+
+  bool isOk() const override { return _open; }
+
+  void close() override { _open = false; }
+
+  double getTime() override;
+
+  int width() const override { return _mode.width(); }
+
+  int height() const override { return _mode.height(); }
+
+  bool isVisible() const override { return _open; }
+
+ private:
+  bool _open;
+  std::chrono::steady_clock::time_point _start;
+};
+
+}  // namespace arty
+
+#endif  // HEADLESS_WINDOW_HPP
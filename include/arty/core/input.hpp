@@ -5,8 +5,9 @@
 #include <arty/core/result.hpp>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
-#include <unordered_set>
+#include <vector>
 
 namespace arty {
 
@@ -42,6 +43,13 @@ ostream& operator<<(ostream& out, arty::Event const& event);
 
 namespace arty {
 
+/**
+ * @brief Turns triggers into events
+ *
+ * Events raised during a frame become visible at the next flush, and stay so
+ * until the one after. They are kept as flags indexed by Event::uuid, so
+ * testing one is a lookup in a vector.
+ */
 class Device {
  public:
   using event_t = Event;
@@ -53,14 +61,30 @@ class Device {
 
   event_t generate(std::string const& name);
 
+  /**
+   * @brief raise an event directly, without trigger
+   */
+  void raise(event_t const& event) { _incomings.push_back(event.uuid()); }
+
   void flush();
 
-  bool occured(event_t const& e);
+  bool occured(event_t const& e) const;
+
+  /**
+   * @brief uuids of the events of the current frame, without duplicates
+   */
+  std::vector<int> const& fired() const { return _fired; }
+
+  /**
+   * @brief make the events of the current frame of other current here too
+   */
+  void merge(Device const& other);
 
  protected:
   std::unordered_map<int, std::unordered_map<Action, event_t>> mapping_;
-  std::unordered_set<event_t> _incomings;
-  std::unordered_set<event_t> _pool;
+  std::vector<int> _incomings;
+  std::vector<int> _fired;
+  std::vector<bool> _flags;
 };
 
 class Keyboard : public Device {
@@ -250,14 +274,40 @@ class InputManager {
 
   bool pop(Event const& event);
 
+  /**
+   * @brief raise an event from code, seen from the next frame on
+   *
+   * Thread safe, systems may emit while others run.
+   */
+  void emit(Event const& event);
+
+  /**
+   * @brief append the uuids of the events of the current frame
+   */
+  void fired(std::vector<int>& uuids) const;
+
   Mouse::position_type position() const;
   void set(Mouse::position_type const& pos);
 
   void flush();
 
+  /**
+   * @brief copy the events of the current frame and the mouse position
+   *
+   * dst answers pop, fired and position like this manager until the next
+   * flush of this one, without the devices: it can be read on one thread
+   * while the devices are used on another. Its own devices are dropped.
+   */
+  void copyTo(InputManager& dst) const;
+
  private:
   Ptr<Mouse> _mouse;
   Ptr<Keyboard> _keyboard;
+  // position without a mouse, as copied
+  Mouse::position_type _position;
+  // events emitted by the systems
+  Device _bus;
+  std::mutex _emitting;
 };
 
 }  // namespace arty
@@ -1,11 +1,22 @@
 #ifndef MEMORY_HPP
 #define MEMORY_HPP
 
-#include <any>
+#include <algorithm>
+#include <arty/core/component_pool.hpp>
+#include <arty/core/component_registry.hpp>
+#include <arty/core/entity.hpp>
 #include <arty/core/result.hpp>
+#include <arty/core/thread_pool.hpp>
+#include <arty/core/view.hpp>
 #include <functional>
-#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace arty {
 
@@ -27,205 +38,527 @@ namespace arty {
  * the blackboad knowing what it is
  *
  * Following rule, if i don't want to save it, it does not belong here
+ *
+ * Singletons (camera, cursor...) are resources: one value per type, stored
+ * apart from the per-entity components and reached with resource<T>().
+ *
+ * Each component type owns a ComponentPool: a dense array of values with a
+ * sparse entity index, see component_pool.hpp. Pools are stored in a flat
+ * table indexed by the ComponentRegistry id of their type.
+ *
+ * view() and process() iterate the live pools, no copy is made. The callback
+ * may write and remove freely: updating a component that already exists is
+ * visible immediately, while adding or removing components of a family being
+ * iterated is postponed until the outermost iteration over it ends.
+ * Families that are not iterated are modified immediately.
+ * Systems should rather record structural changes in their CommandBuffer,
+ * which is played back after the system ran.
+ *
+ * Entities are generational handles allocated by the memory. Removing an
+ * entity recycles its slot, and writes through a stale handle are refused.
+ * Each entity keeps the Signature of the families it belongs to, so removing
+ * it only visits those families.
+ *
+ * Changes are stamped with the current tick. A system remembers the tick of
+ * its last run and asks for what changed(), was added() or removed() since.
+ * The Engine advances the tick before each system.
+ *
+ * Systems running concurrently may create entities and add or remove
+ * components of the families they write: the entity table is locked for
+ * that, and its readers take the lock too. Removing entities must be left to
+ * a CommandBuffer or an exclusive system, see System::removesEntities.
  */
-
-struct Entity {
- private:
-  std::string _name;
-  uint64_t _id;
-  static uint64_t _count;
-
+class Memory {
  public:
-  Entity(std::string const& name, uint64_t id) : _name(name), _id(id) {}
-  Entity() : _name(), _id(0) {}
+  /**
+   * @brief createEntity
+   * @param name optional, for debugging purpose, see name()
+   * @return the real id created
+   */
+  Entity createEntity(std::string const& name = std::string());
 
-  bool operator<(Entity const& rhs) const { return _id < rhs._id; }
-  bool operator>(Entity const& rhs) const { return _id > rhs._id; }
-  bool operator==(Entity const& rhs) const { return _id == rhs._id; }
-  bool operator!=(Entity const& rhs) const { return !(*this == rhs); }
-  bool operator>=(Entity const& rhs) const { return !(*this < rhs); }
-  bool operator<=(Entity const& rhs) const { return !(*this > rhs); }
-  bool isValid() const { return _id != 0 && !_name.empty(); }
-  explicit operator bool() const { return isValid(); }
+  /**
+   * @brief is the handle the current owner of its slot
+   */
+  bool isAlive(Entity const& entity) const;
 
-  static Entity generate(std::string const& name) {
-    return Entity(name, ++_count);
-  }
+  /**
+   * @brief name given at creation, empty if none
+   *
+   * Returned by value, creating an entity can move the names.
+   */
+  std::string name(Entity const& entity) const;
 
-  std::string const& name() const { return _name; }
-  uint64_t id() const { return _id; }
-};
+  /**
+   * @brief store the singleton resource of type T, like the camera
+   *
+   * Resources live outside of every family: they are not counted nor
+   * processed with the components.
+   */
+  template <typename T>
+  bool write(T const& val) {
+    T* res = resource<T>();
+    if (res) {
+      *res = val;
+      return true;
+    }
+    ComponentId id = ComponentRegistry::id<T>();
+    _resources[id] = std::make_shared<T>(val);
+    _copies[id] = &copyResource<T>;
+    return true;
+  }
 
-}  // namespace arty
-namespace std {
+  template <typename T>
+  bool write(Entity const& entity, T const& val) {
+    if (!isAlive(entity)) {
+      return false;
+    }
+    // the signature follows through the pool, see join
+    pool<T>().write(entity, val);
+    return true;
+  }
 
-template <>
-class hash<arty::Entity> {
- public:
-  size_t operator()(arty::Entity const& s) const {
-    return std::hash<uint64_t>()(s.id());
+  template <typename T>
+  bool read(Entity const& entity, T& val) {
+    auto comps = find<T>();
+    if (!comps) {
+      return false;
+    }
+    T const* ptr = comps->find(entity);
+    if (!ptr) {
+      return false;
+    }
+    val = *ptr;
+    return true;
   }
-};
-/*
-static ostream& operator<<(ostream& out, arty::Entity const& e) {
-  out << e.name() + "_" + std::to_string(e.id());
-  return out;
-}
-*/
-}  // namespace std
 
-namespace arty {
+  template <typename T>
+  bool read(T& val) const {
+    T const* res = resource<T>();
+    if (!res) {
+      return false;
+    }
+    val = *res;
+    return true;
+  }
 
-class Memory {
- public:
   /**
-   * @brief createEntity
-   * @param name representing the entity
-   * @return the real id created
+   * @brief direct access to the singleton resource of type T
+   * @return nullptr if it was never written
+   *
+   * The pointer stays valid until the resource is removed or the memory is
+   * cleared, writing a new value does not move it.
    */
-  Entity createEntity(std::string const& name) {
-    return Entity::generate(name);
+  template <typename T>
+  T* resource() {
+    ComponentId id = ComponentRegistry::id<T>();
+    return id < _resources.size() ? static_cast<T*>(_resources[id].get())
+                                  : nullptr;
   }
 
   template <typename T>
-  bool write(T const& val) {
-    return write(Entity(), val);
+  T const* resource() const {
+    ComponentId id = ComponentRegistry::id<T>();
+    return id < _resources.size() ? static_cast<T const*>(_resources[id].get())
+                                  : nullptr;
   }
 
   template <typename T>
-  bool write(Entity const& entity, T const& val) {
-    _components[typeid(T).name()][entity] = val;
+  bool removeResource() {
+    ComponentId id = ComponentRegistry::id<T>();
+    if (id >= _resources.size() || !_resources[id]) {
+      return false;
+    }
+    _resources[id].reset();
     return true;
   }
 
+  /**
+   * @brief direct access to the component of an entity
+   * @return nullptr if the entity has no such component
+   *
+   * The pointer stays valid until the next insertion into or removal from
+   * the family. Those are postponed while the family is iterated, so a
+   * pointer taken inside process(), update() or a view is valid until the
+   * iteration ends.
+   * Taking a mutable pointer marks the component as changed.
+   */
   template <typename T>
-  bool read(Entity const& entity, T& val) {
-    auto it = _components.find(typeid(T).name());
-    if (it != _components.end()) {
-      auto it2 = it->second.find(entity);
-      if (it2 != it->second.end()) {
-        try {
-          val = std::any_cast<T>(it2->second);
-          return true;
-        } catch (const std::bad_any_cast&) {
-          return false;
-        }
-      }
+  T* get(Entity const& entity) {
+    auto comps = find<T>();
+    if (!comps) {
+      return nullptr;
     }
-    return false;
+    comps->touch(entity);
+    return comps->find(entity);
   }
 
   template <typename T>
-  bool read(T& val) {
-    return read(Entity(), val);
+  T const* get(Entity const& entity) const {
+    auto comps = find<T>();
+    return comps ? comps->find(entity) : nullptr;
   }
 
   template <typename T>
   std::size_t count() const {
-    auto it = _components.find(typeid(T).name());
-    if (it != _components.end()) {
-      return it->second.size();
+    auto comps = find<T>();
+    if (comps) {
+      return comps->size();
     }
     return 0;
   }
 
+  /**
+   * @brief size of the largest of the families, resources are ignored
+   */
+  std::size_t count(Signature const& families) const;
+
+  /**
+   * @brief last tick any of the families was modified, 0 if never
+   *
+   * Like changed(), in place modifications are only seen once touched.
+   */
+  Tick modified(Signature const& families) const;
+
   template <typename T>
   bool remove() {
-    return _components.erase(typeid(T).name()) > 0;
+    auto comps = find<T>();
+    if (!comps || comps->size() == 0) {
+      return false;
+    }
+    comps->clear();
+    return true;
   }
 
+  /**
+   * @brief current tick, changes made now are stamped with it
+   */
+  Tick tick() const { return _tick; }
+
+  /**
+   * @brief move to the next tick
+   * @return the new tick
+   *
+   * Not thread safe: only call it when no other system is running.
+   */
+  Tick advance();
+
+  /**
+   * @brief drop the removal logs up to tick
+   */
+  void forget(Tick tick);
+
+  /**
+   * @brief flag an in-place modification, see get()
+   */
   template <typename T>
-  bool remove(Entity const& entity) {
-    return _components[typeid(T).name()].erase(entity) > 0;
+  void touch(Entity const& entity) {
+    auto comps = find<T>();
+    if (comps) {
+      comps->touch(entity);
+    }
   }
 
-  bool remove(Entity const& entity) {
-    for (auto& comp : _components) {
-      comp.second.erase(entity);
+  /**
+   * @brief whether the component of the entity was written after tick
+   */
+  template <typename T>
+  bool changed(Entity const& entity, Tick since) const {
+    auto comps = find<T>();
+    return comps && comps->changedTick(entity) > since;
+  }
+
+  /**
+   * @brief entities whose component was written after tick
+   */
+  template <typename T>
+  std::vector<Entity> changed(Tick since) const {
+    std::vector<Entity> res;
+    auto comps = find<T>();
+    if (!comps) {
+      return res;
     }
-    return true;
+    auto const& ticks = comps->changes();
+    for (std::size_t i = 0; i < ticks.size(); ++i) {
+      if (ticks[i] > since) {
+        res.push_back(comps->entities()[i]);
+      }
+    }
+    return res;
   }
 
-  void clear() { _components.clear(); }
+  /**
+   * @brief entities that gained the component after tick
+   */
+  template <typename T>
+  std::vector<Entity> added(Tick since) const {
+    std::vector<Entity> res;
+    auto comps = find<T>();
+    if (!comps) {
+      return res;
+    }
+    for (auto const& e : comps->entities()) {
+      if (comps->addedTick(e) > since) {
+        res.push_back(e);
+      }
+    }
+    return res;
+  }
 
+  /**
+   * @brief entities that lost the component after tick
+   *
+   * An entity can be listed more than once, and still own the component if
+   * it was added back.
+   */
   template <typename T>
-  Result process(
-      std::function<Result(Entity const& e, T const& comp)> updateFunc) {
-    auto componentContainer = _components[typeid(T).name()];
-    if (componentContainer.size() == 0) {
-      return error("unknown component: " + typeid(T).name());
+  std::vector<Entity> removed(Tick since) const {
+    std::vector<Entity> res;
+    auto comps = find<T>();
+    if (!comps) {
+      return res;
     }
-    auto compIt = componentContainer.begin();
-    auto itEnd = componentContainer.end();
-    try {
-      for (; compIt != itEnd; ++compIt) {
-        T const* val = std::any_cast<T>(&compIt->second);
-        Result r = updateFunc(compIt->first, *val);
-        if (!r) {
-          return r;
-        }
+    for (auto const& r : comps->removed()) {
+      if (r.second > since) {
+        res.push_back(r.first);
       }
-    } catch (const std::bad_any_cast& e) {
-      return error(e.what());
     }
+    return res;
+  }
 
-    return ok();
+  template <typename T>
+  bool remove(Entity const& entity) {
+    auto comps = find<T>();
+    return comps && comps->remove(entity);
   }
 
-  template <typename T1, typename T2>
-  using ProcessFunc2 =
-      std::function<Result(Entity const&, T1 const&, T2 const&)>;
+  /**
+   * @brief remove every component of the entity and recycle its handle
+   */
+  bool remove(Entity const& entity);
+
+  /**
+   * @brief remove a batch of entities
+   * @return the number of entities removed
+   *
+   * Each family is compacted once for the whole batch instead of once per
+   * entity, prefer it when many entities die in the same frame.
+   */
+  std::size_t removeAll(std::vector<Entity> const& entities);
 
-  template <typename T1, typename T2>
-  Result process(ProcessFunc2<T1, T2> updateFunc) {
-    auto container1 = _components[typeid(T1).name()];
-    if (container1.size() == 0) {
-      return error("unknown component: " + typeid(T1).name());
-    }
-    auto c1It = container1.begin();
-    auto c1ItEnd = container1.end();
+  /**
+   * @brief families the entity belongs to
+   */
+  Signature signature(Entity const& entity) const;
+
+  /**
+   * @brief copy the entities, and the families and resources of the
+   * signature, into dst
+   *
+   * Hands a consistent state to systems running while this memory keeps
+   * changing, see Engine::setPipelined. Change ticks and removal logs are
+   * copied along. dst keeps its buffers so copying into it every frame stops
+   * allocating once they are large enough. Its other families are dropped,
+   * names are not copied.
+   * Not thread safe: nothing may modify this memory meanwhile.
+   */
+  void copyTo(Memory& dst, Signature const& families) const;
+
+  /**
+   * @brief remove every component and every entity
+   */
+  void clear();
+
+  /**
+   * @brief iterate over the entities having every component Ts
+   * @see View
+   */
+  template <typename... Ts>
+  View<Ts...> view() {
+    return View<Ts...>(find<Ts>()...);
+  }
 
-    auto container2 = _components[typeid(T2).name()];
-    if (container2.size() == 0) {
-      return error("unknown component: " + typeid(T2).name());
+  /**
+   * @brief call func(Entity const&, Ts const&...) on the entities having
+   * every component Ts
+   *
+   * func is a template parameter so the call is inlined, prefer a lambda
+   * to a std::function. It returns void to visit every entity, bool to stop
+   * at the first false, or Result to stop at the first error, which is then
+   * returned. Fails if one of the families is empty.
+   */
+  template <typename... Ts, typename Func>
+  Result process(Func&& func) {
+    if ((... || (count<Ts>() == 0))) {
+      return error_as(ErrorCode::NOT_FOUND, "unknown component");
     }
-    auto c2It = container2.begin();
-    auto c2ItEnd = container2.end();
-    while (c1It != c1ItEnd && c2It != c2ItEnd) {
-      auto e1 = c1It->first;
-      auto e2 = c2It->first;
-      if (e1 < e2) {
-        ++c1It;
-        continue;
-      }
-      if (e2 < e1) {
-        ++c2It;
-        continue;
+    Result res;
+    for (auto match : view<Ts...>()) {
+      bool next = std::apply(
+          [&res, &func](Entity const& e, Ts&... comps) {
+            return visit(res, func, e, std::as_const(comps)...);
+          },
+          match);
+      if (!next) {
+        break;
       }
-      T1 const* v1;
-      T2 const* v2;
-      try {
-        v1 = std::any_cast<T1>(&c1It->second);
-      } catch (const std::bad_any_cast& e) {
-        return error(e.what());
+    }
+    return res;
+  }
+
+  /**
+   * @brief same as process but func(Entity const&, Ts&...) modifies the
+   * components in place, they are marked as changed
+   */
+  template <typename... Ts, typename Func>
+  Result update(Func&& func) {
+    if ((... || (count<Ts>() == 0))) {
+      return error_as(ErrorCode::NOT_FOUND, "unknown component");
+    }
+    std::tuple<ComponentPool<Ts>*...> pools(find<Ts>()...);
+    Result res;
+    for (auto match : view<Ts...>()) {
+      bool next = std::apply(
+          [&res, &func, &pools](Entity const& e, Ts&... comps) {
+            std::apply(
+                [&e](ComponentPool<Ts>*... p) { (p->touch(e), ...); }, pools);
+            return visit(res, func, e, comps...);
+          },
+          match);
+      if (!next) {
+        break;
       }
-      try {
-        v2 = std::any_cast<T2>(&c2It->second);
-      } catch (const std::bad_any_cast& e) {
-        return error(e.what());
+    }
+    return res;
+  }
+
+  /**
+   * @brief threads used by parallelProcess, serial when null
+   */
+  void setThreadPool(Ptr<ThreadPool> const& pool) { _pool = pool; }
+  Ptr<ThreadPool> const& threadPool() const { return _pool; }
+
+  /**
+   * @brief update the entities having every component Ts, by chunks of
+   * grain entities spread over the thread pool
+   *
+   * func(Entity const&, Ts&...) -> Result is called concurrently: it may
+   * only modify the components of its own entity, in place. Adding or
+   * removing components is not allowed, record them in a CommandBuffer
+   * owned by the chunk instead. Every component handed out is marked as
+   * changed. A chunk stops at its first error.
+   */
+  template <typename... Ts, typename Func>
+  Result parallelProcess(Func func, std::size_t grain = 1024) {
+    View<Ts...> all = view<Ts...>();
+    std::tuple<ComponentPool<Ts>*...> pools(find<Ts>()...);
+    grain = std::max<std::size_t>(grain, 1);
+    std::size_t size = all.size();
+    std::size_t chunks = (size + grain - 1) / grain;
+    std::vector<Result> results(chunks);
+    auto chunk = [&](std::size_t c) {
+      std::size_t first = c * grain;
+      std::size_t last = std::min(size, first + grain);
+      all.each(first, last, [&](Entity const& e, Ts&... comps) {
+        if (!results[c]) {
+          return;
+        }
+        std::apply([&e](ComponentPool<Ts>*... p) { (p->touch(e), ...); },
+                   pools);
+        Result res = func(e, comps...);
+        if (!res) {
+          results[c] = res;
+        }
+      });
+    };
+    if (_pool && chunks > 1) {
+      _pool->parallelFor(chunks, chunk);
+    } else {
+      for (std::size_t c = 0; c < chunks; ++c) {
+        chunk(c);
       }
-      if (!v1 || !v2) {
-        return error("bad_any_cast");
+    }
+    for (auto const& res : results) {
+      if (!res) {
+        return res;
       }
-      return_if_error(updateFunc(c1It->first, *v1, *v2));
-      ++c1It;
-      ++c2It;
     }
     return ok();
   }
 
  private:
-  std::map<std::string, std::map<Entity, std::any>> _components;
+  using ResourceCopy = void (*)(std::shared_ptr<void>&, void const*);
+
+  template <typename T>
+  static void copyResource(std::shared_ptr<void>& dst, void const* src) {
+    T const& val = *static_cast<T const*>(src);
+    if (dst) {
+      *static_cast<T*>(dst.get()) = val;
+    } else {
+      dst = std::make_shared<T>(val);
+    }
+  }
+
+  // call func, tell whether to go on, keep its error in res
+  template <typename Func, typename... Args>
+  static bool visit(Result& res, Func& func, Args&&... args) {
+    using R = std::invoke_result_t<Func&, Args...>;
+    if constexpr (std::is_void_v<R>) {
+      func(std::forward<Args>(args)...);
+      return true;
+    } else if constexpr (std::is_same_v<R, bool>) {
+      return func(std::forward<Args>(args)...);
+    } else {
+      res = func(std::forward<Args>(args)...);
+      return static_cast<bool>(res);
+    }
+  }
+
+  template <typename T>
+  ComponentPool<T>* find() const {
+    ComponentId id = ComponentRegistry::id<T>();
+    if (id >= _families.size()) {
+      return nullptr;
+    }
+    return static_cast<ComponentPool<T>*>(_families[id].get());
+  }
+
+  // isAlive, for callers already holding _structure
+  bool alive(Entity const& entity) const;
+
+  // keeps the signatures in sync with the family, even when the pool
+  // applies the changes later because it was iterated
+  void join(ComponentId id, IComponentPool& family);
+
+  template <typename T>
+  ComponentPool<T>& pool() {
+    auto& family = _families[ComponentRegistry::id<T>()];
+    if (!family) {
+      family.reset(new ComponentPool<T>);
+      family->setTick(_tick);
+      join(ComponentRegistry::id<T>(), *family);
+    }
+    return *static_cast<ComponentPool<T>*>(family.get());
+  }
+
+  // both tables never grow, so they can be read while a system running on
+  // another thread adds a family or a resource
+  std::vector<std::unique_ptr<IComponentPool>> _families =
+      std::vector<std::unique_ptr<IComponentPool>>(MAX_COMPONENTS);
+  // singletons, indexed by ComponentRegistry id as well
+  std::vector<std::shared_ptr<void>> _resources =
+      std::vector<std::shared_ptr<void>>(MAX_COMPONENTS);
+  std::vector<ResourceCopy> _copies =
+      std::vector<ResourceCopy>(MAX_COMPONENTS, nullptr);
+  // entity table, indexed by Entity::index, slot 0 is the invalid entity
+  std::vector<Entity::generation_type> _generations = {0};
+  std::vector<Signature> _signatures = {Signature()};
+  std::vector<Entity::index_type> _free;
+  std::vector<std::string> _names;
+  Tick _tick = 1;
+  // entity table, slots and signature bits
+  mutable std::shared_mutex _structure;
+  Ptr<ThreadPool> _pool;
 };
 
 }  // namespace arty
@@ -0,0 +1,74 @@
+#ifndef PLUGIN_HPP
+#define PLUGIN_HPP
+
+#include <arty/core/result.hpp>
+#include <arty/core/system.hpp>
+#include <filesystem>
+#include <string>
+
+/**
+ * @brief export a system from a shared object, once per plugin
+ *
+ * The system must be default constructible. Build the plugin with
+ * arty_add_plugin() and its host with arty_plugin_host(), so both share the
+ * component ids of arty_core.
+ */
+#define ARTY_PLUGIN(SystemType)                  \
+  extern "C" arty::System* arty_make_system() { \
+    return new SystemType;                       \
+  }
+
+namespace arty {
+
+/**
+ * @brief A system loaded from a shared object, see ARTY_PLUGIN
+ *
+ * The file is copied before being opened: the build can overwrite it while
+ * the previous version runs, and every load gets fresh code even if the
+ * loader caches libraries by path. Libraries are never closed: the
+ * components, resources and callbacks a version put in the Memory may still
+ * point to its code after it was replaced.
+ */
+class Plugin {
+ public:
+  explicit Plugin(std::string const& path) : _path(path) {}
+
+  /**
+   * @brief create a new system from the current content of the file
+   *
+   * On failure the previous system, if any, is kept and reason() tells why.
+   */
+  Result load();
+
+  /**
+   * @brief whether the file was modified since the last load
+   */
+  bool changed() const;
+
+  Ptr<System> const& system() const { return _system; }
+
+  /**
+   * @brief go back to the system replaced by the last load, when the new
+   * one cannot be used, for instance because its init failed
+   */
+  void restore();
+
+  std::string const& path() const { return _path; }
+
+  /**
+   * @brief message of the loader for the last failure
+   */
+  std::string const& reason() const { return _error; }
+
+ private:
+  std::string _path;
+  std::filesystem::file_time_type _time;
+  Ptr<System> _system;
+  Ptr<System> _previous;
+  std::size_t _loads = 0;
+  std::string _error;
+};
+
+}  // namespace arty
+
+#endif  // PLUGIN_HPP
@@ -0,0 +1,149 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <arty/core/result.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace arty {
+
+/**
+ * @brief One measure: a system init or process call, or a whole frame
+ */
+struct ProfileSample {
+  enum Kind : std::uint8_t { INIT, PROCESS, FRAME };
+
+  // index of the name in the Profiler
+  std::uint32_t name = 0;
+  Kind kind = PROCESS;
+  // small id of the thread that ran it
+  std::uint32_t thread = 0;
+  std::uint64_t frame = 0;
+  // nanoseconds, start is relative to the creation of the Profiler
+  std::int64_t start = 0;
+  std::int64_t duration = 0;
+  // size of the largest family the system declared
+  std::size_t entities = 0;
+  // heap allocations, only counted with ARTY_PROFILE_ALLOCATIONS
+  std::size_t allocations = 0;
+};
+
+static_assert(std::is_trivially_copyable_v<ProfileSample>);
+
+/**
+ * @brief Keeps the last timings of the systems
+ *
+ * Samples go to a fixed size ring buffer, the oldest ones being overwritten.
+ * Recording is lock free and can happen from any thread, even while the
+ * samples are read: each slot is guarded by a sequence number and readers
+ * skip the ones being written.
+ * Samples are grouped by name, systems of the same type share theirs.
+ */
+class Profiler {
+ public:
+  /**
+   * @brief timings of a name over the last frames
+   */
+  struct Summary {
+    std::string name;
+    std::size_t calls = 0;
+    // average per frame, and the longest call
+    double frameMs = 0.;
+    double maxMs = 0.;
+    std::size_t entities = 0;
+    std::size_t allocations = 0;
+  };
+
+  /**
+   * @param capacity number of samples kept, rounded up to a power of 2
+   */
+  explicit Profiler(std::size_t capacity = 1 << 14);
+
+  /**
+   * @brief index of a name, added if unknown
+   */
+  std::uint32_t add(std::string const& name);
+
+  /**
+   * @brief name of an index, the reference stays valid as names are added
+   */
+  std::string const& name(std::uint32_t index) const;
+
+  /**
+   * @brief start a new frame, samples record the current one
+   */
+  void nextFrame() { _frame.fetch_add(1); }
+
+  std::uint64_t frame() const { return _frame.load(); }
+
+  /**
+   * @brief start measuring, the sample is recorded by end()
+   */
+  ProfileSample begin(std::uint32_t name, ProfileSample::Kind kind) const;
+
+  void end(ProfileSample& sample, std::size_t entities = 0);
+
+  void record(ProfileSample const& sample);
+
+  /**
+   * @brief samples still in the buffer, oldest first
+   */
+  std::vector<ProfileSample> samples() const;
+
+  /**
+   * @brief process timings of the last frames, slowest first
+   */
+  std::vector<Summary> summary(std::size_t frames = 60) const;
+
+  /**
+   * @brief write the samples as Chrome trace events
+   *
+   * Open the file in chrome://tracing or https://ui.perfetto.dev
+   */
+  void writeTrace(std::ostream& os) const;
+
+  Result exportTrace(std::string const& path) const;
+
+  /**
+   * @brief heap allocations made by the calling thread so far
+   */
+  static std::size_t allocations();
+
+ private:
+  static constexpr std::size_t WORDS = (sizeof(ProfileSample) + 7) / 8;
+
+  struct Slot {
+    // 2 * (index + 1) once the sample of that index is stored, odd while it
+    // is written
+    std::atomic<std::uint64_t> seq;
+    std::array<std::atomic<std::uint64_t>, WORDS> words;
+  };
+
+  std::int64_t now() const;
+  bool read(std::uint64_t index, ProfileSample& sample) const;
+
+  std::chrono::steady_clock::time_point _origin;
+  std::unique_ptr<Slot[]> _ring;
+  std::size_t _size;
+  std::size_t _mask;
+  std::atomic<std::uint64_t> _head{0};
+  std::atomic<std::uint64_t> _frame{0};
+  mutable std::mutex _mutex;
+  // deque keeps the returned references valid when names are added
+  std::deque<std::string> _names;
+  std::map<std::string, std::uint32_t> _indices;
+};
+
+}  // namespace arty
+
+#endif  // PROFILER_HPP
@@ -1,61 +1,105 @@
 #ifndef RESULT_H
 #define RESULT_H
 
+#include <cstdint>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <type_traits>
 
-#define return_if_error(result) \
-  do {                          \
-    if (!result) {              \
-      return Result(#result);   \
-    }                           \
-  } while (0);
+#define return_if_error(result)        \
+  do {                                 \
+    arty::Result arty_result_(result); \
+    if (!arty_result_) {               \
+      return arty_result_;             \
+    }                                  \
+  } while (0)
 
 namespace arty {
 template <typename T>
 using Ptr = std::shared_ptr<T>;
 
+enum class ErrorCode : std::uint8_t { OK = 0, FAILED, NOT_FOUND, INVALID, IO };
+
+/**
+ * @brief Where an error is raised, one static instance per error() call
+ */
+struct ErrorSite {
+  char const* file;
+  int line;
+  char const* message;
+};
+
+/**
+ * @brief Success, or an error code with the site that raised it
+ *
+ * It is two words and trivially copyable: nothing is allocated nor printed
+ * when an error is raised, message() formats it when asked. Use logError()
+ * to print errors that may repeat every frame.
+ */
 class Result {
  public:
-  Result() : _is_ok(true), _error() {}
-  Result(std::string const& msg) : _is_ok(false), _error(msg) {
-    std::cerr << msg << std::endl;
-  }
-  Result(bool b) : _is_ok(b), _error() {
-    if (!_is_ok) {
-      _error = std::string("unknown error");
-    }
-  }
-
-  explicit operator bool() const { return _is_ok; }
-  bool operator==(Result const& r) const { return _is_ok == r._is_ok; }
-
-  std::string message() const {
-    if (_is_ok) {
-      return "ok";
-    }
-    return _error;
-  }
-
-  void panic() const {
-    if (!_is_ok) {
-      std::cerr << _error << std::endl;
-      throw std::runtime_error(_error);
-    }
-  }
+  Result() : _code(ErrorCode::OK), _site(nullptr) {}
+  Result(bool b)
+      : _code(b ? ErrorCode::OK : ErrorCode::FAILED), _site(nullptr) {}
+  Result(ErrorCode code, ErrorSite const* site) : _code(code), _site(site) {}
+
+  explicit operator bool() const { return _code == ErrorCode::OK; }
+  bool operator==(Result const& r) const { return _code == r._code; }
+
+  ErrorCode code() const { return _code; }
+
+  /**
+   * @brief null on success and for Result(false)
+   */
+  ErrorSite const* site() const { return _site; }
+
+  /**
+   * @brief "file:line:message", formatted on each call
+   */
+  std::string message() const;
+
+  /**
+   * @brief throw a std::runtime_error if it is an error
+   */
+  void panic() const;
 
  private:
-  bool _is_ok;
-  std::string _error;
+  ErrorCode _code;
+  ErrorSite const* _site;
 };
 
+static_assert(std::is_trivially_copyable_v<Result>);
+
+/**
+ * @brief print an error to std::cerr, at most once per second and per site
+ * @param detail known only at run time, like a loader message, appended to
+ * the message of the site
+ *
+ * Repetitions in between are counted and reported with the next print.
+ * Thread safe, successes are ignored.
+ */
+void logError(Result const& res, std::string const& detail = std::string());
+
 }  // namespace arty
 
 std::ostream& operator<<(std::ostream& os, arty::Result const& r);
 
 #define ok() arty::Result()
-#define error(msg)                                                      \
-  arty::Result(__FILE__ + std::string(":") + std::to_string(__LINE__) + \
-               std::string(":") + msg)
+
+/**
+ * @brief error raised here, msg must be a string literal
+ */
+#define error(msg) error_as(arty::ErrorCode::FAILED, msg)
+
+/**
+ * @brief same with a specific code
+ */
+#define error_as(code, msg)                                         \
+  ([]() {                                                           \
+    static constexpr arty::ErrorSite arty_site_{__FILE__, __LINE__, \
+                                                msg};               \
+    return arty::Result(code, &arty_site_);                         \
+  }())
 
 #endif  // RESULT_H
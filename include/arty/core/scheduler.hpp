@@ -0,0 +1,86 @@
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+
+#include <arty/core/profiler.hpp>
+#include <arty/core/system.hpp>
+#include <arty/core/thread_pool.hpp>
+
+namespace arty {
+
+/**
+ * @brief Runs systems concurrently when their Access allows it
+ *
+ * Systems are grouped into stages: a system goes in the stage right after
+ * the last one holding a system, registered before it, it conflicts with.
+ * Systems of a stage therefore never touch a family another one writes, and
+ * running them in any order gives the result of the serial order.
+ * The stages run one after the other. In a stage, systems bound to the main
+ * thread run on the caller while the others go to the thread pool. The tick
+ * of the memory is advanced before each stage and the command buffers are
+ * flushed after it, in registration order.
+ * With a Profiler, every process call is timed.
+ *
+ * Systems that sleep, see System::wakesOn and System::watches, are skipped
+ * unless one of their events fired or a family they watch was modified
+ * since they last ran. Stages where everybody sleeps are skipped entirely,
+ * without advancing the tick. The result of a skipped system is ok().
+ */
+class Scheduler {
+ public:
+  /**
+   * @param pool threads to run on, everything runs on the caller if null
+   */
+  explicit Scheduler(Ptr<ThreadPool> const& pool = nullptr) : _pool(pool) {}
+
+  void setPool(Ptr<ThreadPool> const& pool) { _pool = pool; }
+
+  /**
+   * @brief record the process calls, takes effect at the next build
+   */
+  void setProfiler(Ptr<Profiler> const& profiler) { _profiler = profiler; }
+
+  /**
+   * @brief group the systems into stages, in registration order
+   */
+  void build(std::vector<Ptr<System>> const& systems);
+
+  /**
+   * @brief run every stage once
+   * @return the result of each system, in registration order
+   */
+  std::vector<Result> const& run(Ptr<Memory> const& mem,
+                                 Ptr<InputManager> const& inputs);
+
+  std::vector<std::vector<std::size_t>> const& stages() const {
+    return _stages;
+  }
+
+  std::size_t size() const { return _systems.size(); }
+
+ private:
+  Result process(std::size_t index, Ptr<Memory> const& mem,
+                 Ptr<InputManager> const& inputs);
+  bool awake(std::size_t index, Memory const& mem) const;
+
+  Ptr<ThreadPool> _pool;
+  Ptr<Profiler> _profiler;
+  // profiler name of each system
+  std::vector<std::uint32_t> _names;
+  std::vector<Ptr<System>> _systems;
+  // indices into _systems
+  std::vector<std::vector<std::size_t>> _stages;
+  std::vector<Result> _results;
+  // systems subscribed to each event, indexed by Event::uuid
+  std::vector<std::vector<std::size_t>> _subscribers;
+  // woken by an event for the current run
+  std::vector<bool> _awake;
+  // modified tick of the watched families after the last run of the system
+  std::vector<Tick> _seen;
+  // scratch buffers, kept to not allocate every frame
+  std::vector<int> _fired;
+  std::vector<std::size_t> _running;
+};
+
+}  // namespace arty
+
+#endif  // SCHEDULER_HPP
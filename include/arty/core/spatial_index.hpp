@@ -0,0 +1,35 @@
+#ifndef SPATIAL_INDEX_HPP
+#define SPATIAL_INDEX_HPP
+
+#include <arty/core/aabb_tree.hpp>
+#include <arty/core/memory.hpp>
+
+namespace arty {
+
+/**
+ * @brief AABBTree of the Tf3f moved AABox3f of a Memory
+ *
+ * Each sync only looks at the components written or removed since the
+ * previous one: boxes that did not move cost nothing.
+ */
+class SpatialIndex {
+ public:
+  explicit SpatialIndex(float margin = 0.1f) : _tree(margin) {}
+
+  /**
+   * @brief bring the tree up to date with the memory
+   */
+  void sync(Memory const& mem);
+
+  AABBTree const& tree() const { return _tree; }
+
+ private:
+  void update(Memory const& mem, Entity const& entity);
+
+  AABBTree _tree;
+  Tick _since = 0;
+};
+
+}  // namespace arty
+
+#endif  // SPATIAL_INDEX_HPP
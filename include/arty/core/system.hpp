@@ -1,12 +1,52 @@
 #ifndef SYSTEM_HPP
 #define SYSTEM_HPP
 
+#include <arty/core/command_buffer.hpp>
 #include <arty/core/input.hpp>
 #include <arty/core/memory.hpp>
 #include <arty/core/result.hpp>
 
 namespace arty {
 
+/**
+ * @brief Component types a system reads and writes in process
+ *
+ * Resources and pseudo types (like InputManager for the devices) are
+ * declared the same way. A system that declares nothing is exclusive: it
+ * runs alone, on the main thread.
+ * Creating entities needs no declaration, Memory::createEntity can run
+ * concurrently with the readers of the entity table. Killing them does:
+ * record it in the CommandBuffer, flushed once the stage is over, or declare
+ * removesEntities to run alone.
+ */
+struct Access {
+  Signature reads;
+  Signature writes;
+  bool declared = false;
+  // removing entities touches every family
+  bool removes = false;
+  // needs the thread owning the window (rendering, devices)
+  bool mainThread = true;
+  // runs once per fixed simulation step instead of once per frame
+  bool fixedStep = false;
+  // only reads what it declared, to draw it
+  bool rendering = false;
+  // when not empty, only runs when one of the events fired or one of the
+  // watched families was modified since its last run
+  std::vector<Event> events;
+  Signature watches;
+
+  bool sleeps() const { return !events.empty() || watches.any(); }
+
+  bool conflicts(Access const& other) const {
+    if (!declared || !other.declared || removes || other.removes) {
+      return true;
+    }
+    return (writes & (other.reads | other.writes)).any() ||
+           (other.writes & reads).any();
+  }
+};
+
 class System {
  public:
   virtual ~System() {}
@@ -19,7 +59,82 @@ class System {
   virtual Result init(Ptr<Memory> const& board);
   virtual void release();
 
+  /**
+   * @brief name given to the Profiler, the type of the system by default
+   */
+  virtual std::string name() const;
+
+  /**
+   * @brief structural changes recorded during process, flushed by the Engine
+   */
+  CommandBuffer& commands() { return _commands; }
+
+  Access const& access() const { return _access; }
+
  protected:
+  template <typename... Ts>
+  void reads() {
+    _access.declared = true;
+    (_access.reads.set(ComponentRegistry::id<Ts>()), ...);
+  }
+
+  template <typename... Ts>
+  void writes() {
+    _access.declared = true;
+    (_access.writes.set(ComponentRegistry::id<Ts>()), ...);
+  }
+
+  /**
+   * @brief process removes entities from the memory directly, it runs alone
+   */
+  void removesEntities() {
+    _access.declared = true;
+    _access.removes = true;
+  }
+
+  /**
+   * @brief allow process to run on a worker thread
+   */
+  void anyThread() { _access.mainThread = false; }
+
+  /**
+   * @brief process simulates one SimulationClock step, see Engine::step
+   */
+  void fixedStep() { _access.fixedStep = true; }
+
+  /**
+   * @brief process draws the families it reads and modifies nothing
+   *
+   * A pipelined Engine runs it on a snapshot holding only those families,
+   * while the next frame is simulated, see Engine::setPipelined.
+   */
+  void renders() {
+    _access.declared = true;
+    _access.rendering = true;
+  }
+
+  /**
+   * @brief process only runs on the frames the event fired
+   *
+   * Can be combined with watches(), a sleeping system costs nothing to the
+   * Scheduler.
+   */
+  void wakesOn(Event const& event) { _access.events.push_back(event); }
+
+  /**
+   * @brief process only runs once the families were modified since its last
+   * run, and reads them
+   *
+   * Modifications the system makes itself do not wake it up again.
+   */
+  template <typename... Ts>
+  void watches() {
+    reads<Ts...>();
+    (_access.watches.set(ComponentRegistry::id<Ts>()), ...);
+  }
+
+  CommandBuffer _commands;
+  Access _access;
 };
 
 class EventSystem : public System {
@@ -27,7 +142,9 @@ class EventSystem : public System {
   using job_func = std::function<Result(Ptr<Memory> const& board)>;
 
   EventSystem(Input const& input, Event const& event, job_func job)
-      : _input(input), _event(event), _job(job){};
+      : _input(input), _event(event), _job(job) {
+    wakesOn(_event);
+  }
 
   Result process(Ptr<Memory> const& board,
                  Ptr<InputManager> const& inputs) override;
@@ -0,0 +1,79 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace arty {
+
+/**
+ * @brief Work stealing pool of threads
+ *
+ * Every worker owns a queue: it pops its own tasks from the back and, once
+ * empty, steals from the front of the others. Tasks submitted from a worker
+ * go to its own queue, the others are spread round robin.
+ * The thread calling wait() works too, so a pool of size n starts n - 1
+ * threads and a pool of size 1 runs everything in wait().
+ */
+class ThreadPool {
+ public:
+  using task_type = std::function<void()>;
+
+  explicit ThreadPool(std::size_t size = std::thread::hardware_concurrency());
+  ~ThreadPool();
+
+  ThreadPool(ThreadPool const&) = delete;
+  ThreadPool& operator=(ThreadPool const&) = delete;
+
+  /**
+   * @brief number of threads working, the caller of wait() included
+   */
+  std::size_t size() const { return _workers.size() + 1; }
+
+  void submit(task_type task);
+
+  /**
+   * @brief run tasks until every submitted task is done
+   */
+  void wait();
+
+  /**
+   * @brief run body(i) for every i in [0, count), return once they are done
+   *
+   * Unlike wait(), it only waits for its own tasks, so it can be called from
+   * a task. The caller runs tasks while waiting.
+   */
+  void parallelFor(std::size_t count,
+                   std::function<void(std::size_t)> const& body);
+
+ private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<task_type> tasks;
+  };
+
+  void work(std::size_t self);
+  bool pop(std::size_t self, task_type& task);
+  void run(task_type& task);
+
+  // queue 0 belongs to the threads outside of the pool
+  std::vector<std::unique_ptr<Queue>> _queues;
+  std::vector<std::thread> _workers;
+  std::atomic<std::size_t> _queued{0};
+  std::atomic<std::size_t> _pending{0};
+  std::atomic<std::size_t> _next{0};
+  bool _stop = false;
+  std::mutex _mutex;
+  std::condition_variable _wake;
+  std::condition_variable _done;
+};
+
+}  // namespace arty
+
+#endif  // THREAD_POOL_HPP
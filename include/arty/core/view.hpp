@@ -0,0 +1,143 @@
+#ifndef VIEW_HPP
+#define VIEW_HPP
+
+#include <arty/core/component_pool.hpp>
+#include <tuple>
+
+namespace arty {
+
+/**
+ * @brief Iterable join over the entities having every component Ts
+ *
+ * The walk is driven by the smallest family, the others are probed through
+ * their sparse index, so the cost is the size of the smallest set.
+ * Components are handed out by reference and can be modified in place:
+ *
+ *   for (auto [e, tf, box] : mem.view<Tf3f, AABox3f>()) { ... }
+ *
+ * The view locks every pool it joins for as long as it lives, with the same
+ * rules as Memory::process: insertions and removals into those families are
+ * applied when the view is destroyed.
+ * Modifications made through the view are not tracked as changes, use
+ * Memory::touch for the ones that matter.
+ */
+template <typename... Ts>
+class View {
+  static_assert(sizeof...(Ts) > 0, "a view needs at least one component");
+
+ public:
+  using pools_type = std::tuple<ComponentPool<Ts>*...>;
+  using value_type = std::tuple<Entity const&, Ts&...>;
+
+  class iterator {
+   public:
+    iterator(View const* view, std::size_t index, std::size_t last)
+        : _view(view), _index(index), _last(last) {
+      skip();
+    }
+
+    iterator(View const* view, std::size_t index)
+        : iterator(view, index, view->size()) {}
+
+    value_type operator*() const {
+      return std::apply(
+          [this](Ts*... comps) -> value_type {
+            return value_type((*_view->_entities)[_index], *comps...);
+          },
+          _current);
+    }
+
+    iterator& operator++() {
+      ++_index;
+      skip();
+      return *this;
+    }
+
+    bool operator==(iterator const& other) const {
+      return _index == other._index;
+    }
+    bool operator!=(iterator const& other) const { return !(*this == other); }
+
+   private:
+    // Move forward until an entity has every component of the view
+    void skip() {
+      for (; _index < _last; ++_index) {
+        Entity const& e = (*_view->_entities)[_index];
+        _current = std::apply(
+            [&e](ComponentPool<Ts>*... pools) {
+              return std::tuple<Ts*...>(pools->find(e)...);
+            },
+            _view->_pools);
+        if (std::apply([](Ts*... comps) { return (... && (comps != nullptr)); },
+                       _current)) {
+          return;
+        }
+      }
+    }
+
+    View const* _view;
+    std::size_t _index;
+    std::size_t _last;
+    std::tuple<Ts*...> _current;
+  };
+
+  View(ComponentPool<Ts>*... pools) : _pools(pools...), _entities(nullptr) {
+    bool complete = (... && (pools != nullptr));
+    if (!complete) {
+      return;
+    }
+    (pools->lock(), ...);
+    IComponentPool const* driver = nullptr;
+    (select(driver, pools), ...);
+    _entities = &driver->entities();
+  }
+
+  ~View() {
+    if (_entities) {
+      std::apply([](ComponentPool<Ts>*... pools) { (pools->unlock(), ...); },
+                 _pools);
+    }
+  }
+
+  View(View const&) = delete;
+  View& operator=(View const&) = delete;
+
+  iterator begin() const { return iterator(this, 0); }
+  iterator end() const { return iterator(this, size()); }
+
+  /**
+   * @brief upper bound of the number of entities in the view
+   */
+  std::size_t size() const { return _entities ? _entities->size() : 0; }
+
+  bool empty() const { return begin() == end(); }
+
+  /**
+   * @brief call func(entity, comps...) for the matches among the entities
+   * [first, last) of the driving family
+   *
+   * Slices of the range can be walked concurrently.
+   */
+  template <typename Func>
+  void each(std::size_t first, std::size_t last, Func&& func) const {
+    for (iterator it(this, first, last), end(this, last, last); it != end;
+         ++it) {
+      std::apply(func, *it);
+    }
+  }
+
+ private:
+  static void select(IComponentPool const*& driver,
+                     IComponentPool const* pool) {
+    if (!driver || pool->size() < driver->size()) {
+      driver = pool;
+    }
+  }
+
+  pools_type _pools;
+  std::vector<Entity> const* _entities;
+};
+
+}  // namespace arty
+
+#endif  // VIEW_HPP
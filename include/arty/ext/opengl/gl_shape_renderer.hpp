@@ -2,6 +2,7 @@
 #define GL_SHAPE_RENDERER_HPP
 
 #include <arty/impl/hitbox_rendering_system.hpp>
+#include <array>
 
 namespace arty {
 
@@ -11,6 +12,16 @@ class GlShapeRenderer : public IShapeRenderer {
   unsigned int _program;
   int _mvp;
   std::unordered_map<Entity, unsigned int> _vbos;
+  // line lists of the shapes, uploaded again only when the shape changes
+  enum Kind { AABOX, OBB, SPHERE, KINDS };
+  using Params = std::array<float, 15>;
+  struct Shape {
+    unsigned int vbo = 0;
+    int count = 0;
+    Params params{};
+  };
+  // an entity can be drawn with a shape of each kind
+  std::unordered_map<Entity, std::array<Shape, KINDS>> _shapes;
 
   // IShapeRenderer interface
  public:
@@ -29,8 +40,15 @@ class GlShapeRenderer : public IShapeRenderer {
   void draw(const Entity& e, const std::vector<Vec3f>& s, const Mat4x4f& model,
             const Mat4x4f& view, const Mat4x4f& proj) override;
 
+  void forget(const Entity& e) override;
+
  private:
   void import(Entity const& e, const std::vector<Vec3f>& s);
+  bool drawCached(Entity const& e, Kind kind, Params const& params,
+                  const Mat4x4f& mvp);
+  void cache(Entity const& e, Kind kind, Params const& params,
+             const std::vector<Vec3f>& s, const Mat4x4f& mvp);
+  void drawBuffer(unsigned int vbo, int count, const Mat4x4f& mvp);
 };
 
 }  // namespace arty
@@ -21,7 +21,14 @@ class Camera {
 
   mat_type const& projection() const { return _projection; }
   mat_type view() const { return _inv_rot * _inv_tran; }
-  mat_type transform() const { return (-_inv_tran) * _inv_rot.transpose(); }
+  mat_type transform() const {
+    // inverse of the view: rotate back, then translate back to the eye
+    mat_type tran = _inv_tran;
+    for (std::size_t i = 0; i < 3; ++i) {
+      tran(i, 3) = -tran(i, 3);
+    }
+    return tran * _inv_rot.transpose();
+  }
   point_type position() const {
     return transform().block<number_type, 3, 1>(0, 3);
   }
@@ -34,14 +41,14 @@ class Camera {
   void lookAt(point_type const& eye, point_type const& target,
               point_type const& updir);
 
-  ray_type raycast(pixel_type const& pixel) {
+  ray_type raycast(pixel_type const& pixel) const {
     vector_type mpp(pixel, -1.f, 1.f);
     auto dir = transform() * mpp;
     auto ori = point_type(-_inv_tran(0, 3), -_inv_tran(1, 3), -_inv_tran(2, 3));
     return ray_type(ori, point_type(dir.x(), dir.y(), dir.z()));
   }
 
-  number_type distanceTo(point_type const& pt) {
+  number_type distanceTo(point_type const& pt) const {
     auto cam = point_type(-_inv_tran(0, 3), -_inv_tran(1, 3), -_inv_tran(2, 3));
     return (cam - pt).norm();
   }
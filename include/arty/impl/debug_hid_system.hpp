@@ -1,20 +1,28 @@
 #ifndef DEBUG_HID_SYSTEM_HPP
 #define DEBUG_HID_SYSTEM_HPP
 
+#include <arty/core/profiler.hpp>
 #include <arty/core/renderer.hpp>
 #include <arty/core/system.hpp>
 #include <arty/core/window.hpp>
 
 namespace arty {
 
+/**
+ * @brief Shows the frame rate and, given a Profiler, the slowest systems
+ */
 class DebugHidSystem : public System {
  public:
-  DebugHidSystem(Ptr<Window> window, Ptr<ITextRenderer> renderer)
-      : _window(window), _renderer(renderer) {}
+  DebugHidSystem(Ptr<Window> window, Ptr<ITextRenderer> renderer,
+                 Ptr<Profiler> profiler = nullptr)
+      : _window(window), _renderer(renderer), _profiler(profiler) {
+    renders();
+  }
 
  private:
   Ptr<Window> _window;
   Ptr<ITextRenderer> _renderer;
+  Ptr<Profiler> _profiler;
 
   // System interface
  public:
@@ -1,13 +1,31 @@
 #ifndef ENGINE_HPP
 #define ENGINE_HPP
 
+#include <arty/core/clock.hpp>
 #include <arty/core/input.hpp>
+#include <arty/core/plugin.hpp>
+#include <arty/core/profiler.hpp>
 #include <arty/core/result.hpp>
+#include <arty/core/scheduler.hpp>
 #include <arty/core/system.hpp>
 #include <arty/core/window.hpp>
 
 namespace arty {
 
+/**
+ * @brief Runs the systems, frame after frame
+ *
+ * Systems declared fixedStep run first, once per simulation step: the time
+ * elapsed since the previous frame is accumulated and consumed by steps of
+ * 1 / stepRate seconds. At most maxSteps are run per frame, the rest of the
+ * time is dropped so a slow frame does not make the next ones slower.
+ * The other systems run once per frame afterwards, with the SimulationClock
+ * resource telling how far between two steps the frame is.
+ *
+ * Once pipelined, rendering systems (see System::renders) draw a snapshot
+ * of the previous frame on the calling thread while the other systems
+ * simulate the next one on a thread of their own.
+ */
 class Engine {
  public:
   Engine() : _window(), _systems(), _state(), _inputs(new InputManager) {}
@@ -30,13 +48,76 @@ class Engine {
     return this->addSystem(Ptr<DerivedSystem>(new DerivedSystem(args...)));
   }
 
+  /**
+   * @brief add a system loaded from a shared object, see ARTY_PLUGIN
+   *
+   * It is loaded by start(). Whenever the file is modified, the new version
+   * is loaded and initialized at the beginning of the next frame, then
+   * replaces the previous one, which is released. The board is kept: init
+   * runs again on it. If the new version fails to load or to init, the
+   * error is logged and the previous one keeps running.
+   */
+  Engine& addPlugin(std::string const& path);
+
   Engine& setBoard(Ptr<Memory> const& board);
 
+  /**
+   * @brief number of threads running the systems, 1 runs them serially
+   */
+  Engine& setThreads(std::size_t threads);
+
+  /**
+   * @brief fixed steps per simulated second, 1800 by default
+   */
+  Engine& setStepRate(double hz);
+
+  /**
+   * @brief maximum number of fixed steps per frame
+   */
+  Engine& setMaxSteps(std::size_t steps);
+
+  /**
+   * @brief run without presenting anything
+   * @param frameRate simulated frames per second
+   * @param realTime pace run() at frameRate, otherwise run as fast as
+   * possible
+   *
+   * The window is never cleared nor refreshed and need not have a size, a
+   * HeadlessWindow is used if none is set. Every frame simulates exactly
+   * 1 / frameRate seconds, whatever the time it took.
+   */
+  Engine& setHeadless(double frameRate = 60., bool realTime = false);
+
+  /**
+   * @brief overlap the rendering of a frame with the simulation of the next
+   *
+   * Every frame, the families and resources the rendering systems read are
+   * copied into a snapshot Memory, which they draw during the next frame
+   * while the other systems update the board. What is displayed is one
+   * frame behind. They also get a copy of the input events of the frame,
+   * the devices belong to the simulation. The window is refreshed, and
+   * device events polled, once both are done.
+   * The non rendering systems, main thread and undeclared ones included, no
+   * longer run on the calling thread: a system issuing draw calls, or using
+   * the window in any way, must declare System::renders.
+   */
+  Engine& setPipelined(bool pipelined = true);
+
+  /**
+   * @brief time every init, process and frame, set it before start()
+   */
+  Engine& setProfiler(Ptr<Profiler> const& profiler);
+
+  Ptr<Profiler> profiler() const { return _profiler; }
+
   Result start();
 
   Result step();
 
-  Result run();
+  /**
+   * @brief step until the window closes, or for a number of frames
+   */
+  Result run(std::size_t frames = 0);
 
   void stop();
 
@@ -47,6 +128,35 @@ class Engine {
   std::vector<Ptr<System>> _systems;
   Ptr<Memory> _state;
   Ptr<InputManager> _inputs;
+  Result schedule();
+  std::size_t accumulate(double elapsed);
+  void simulate(std::size_t steps);
+  void reload();
+
+  Ptr<ThreadPool> _pool;
+  Ptr<Profiler> _profiler;
+  std::uint32_t _frameName = 0;
+  Scheduler _fixed;
+  Scheduler _scheduler;
+  bool _scheduled = false;
+  bool _pipelined = false;
+  Scheduler _render;
+  Ptr<Memory> _snapshot;
+  Signature _snapshotFamilies;
+  // input events of the frame, as seen by the rendering systems
+  Ptr<InputManager> _renderInputs;
+  // runs the simulation while the caller renders
+  Ptr<ThreadPool> _simulation;
+  double _stepRate = 1800.;
+  std::size_t _maxSteps = 90;
+  double _accumulator = 0.;
+  double _lastTime = -1.;
+  bool _headless = false;
+  bool _realTime = false;
+  double _frameRate = 60.;
+  Tick _lastFrame = 0;
+  // with the index of their system in _systems
+  std::vector<std::pair<std::size_t, Plugin>> _plugins;
 };
 
 }  // namespace arty
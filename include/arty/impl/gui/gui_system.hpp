@@ -19,8 +19,7 @@ class GuiSystem : public System {
   void release();
 
  public:
-  GuiSystem(Ptr<Window> window, Ptr<Renderer> renderer)
-      : _window(window), _renderer(renderer) {}
+  GuiSystem(Ptr<Window> window, Ptr<Renderer> renderer);
 };
 
 struct ButtonBuilder;
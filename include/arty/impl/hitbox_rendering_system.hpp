@@ -2,7 +2,9 @@
 #define HITBOX_RENDERING_SYSTEM_HPP
 
 #include <arty/core/geometry.hpp>
+#include <arty/core/spatial_index.hpp>
 #include <arty/core/system.hpp>
+#include <arty/impl/camera_system.hpp>
 
 namespace arty {
 
@@ -25,15 +27,27 @@ class IShapeRenderer {
                     const Mat4x4f& model, const Mat4x4f& view,
                     const Mat4x4f& proj) = 0;
 
+  /**
+   * @brief the entity lost its shapes, renderers caching them shall free
+   * what they keep for it
+   */
+  virtual void forget(const Entity& e) = 0;
+
   virtual void release() = 0;
 };
 
 class HitBoxRenderingSystem : public System {
  public:
-  HitBoxRenderingSystem(Ptr<IShapeRenderer> rend) : _renderer(rend) {}
+  HitBoxRenderingSystem(Ptr<IShapeRenderer> rend) : _renderer(rend) {
+    reads<Camera, Tf3f, AABox3f, OBB3f, Sphere3f>();
+    renders();
+  }
 
  private:
   Ptr<IShapeRenderer> _renderer;
+  Tick _lastRun = 0;
+  // boxes out of the view are not drawn
+  SpatialIndex _index;
   // System interface
  public:
   Result process(const Ptr<Memory>& board) override;
@@ -2,6 +2,7 @@
 #define MOUSE_SYSTEM_HPP
 
 #include <arty/core/input.hpp>
+#include <arty/core/spatial_index.hpp>
 #include <arty/core/system.hpp>
 #include <arty/impl/camera_system.hpp>
 #include <arty/impl/hitbox_rendering_system.hpp>
@@ -15,10 +16,17 @@ struct Selected {
 
 class MouseSystem : public System {
  public:
+  MouseSystem() {
+    reads<Camera, Tf3f, AABox3f, InputManager>();
+    writes<Selected>();
+  }
+
   Result process(Ptr<Memory> const& mem,
                  Ptr<InputManager> const& inputs) override;
 
  private:
+  // the ray only visits the boxes along it
+  SpatialIndex _index;
 };
 
 }  // namespace arty
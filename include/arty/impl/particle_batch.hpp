@@ -0,0 +1,101 @@
+#ifndef PARTICLE_BATCH_HPP
+#define PARTICLE_BATCH_HPP
+
+#include <arty/impl/physics.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace arty {
+
+/**
+ * @brief Particles laid out component by component, integrated many at a
+ * time with the widest vector instructions of the processor
+ *
+ * The forces accumulated by a particle are divided by its mass when it is
+ * pushed, and spent by the next step as in Physics::integrateMotion, while
+ * gravity stays. Damping to the power of the step is computed once per run
+ * of particles sharing their damping, instead of once per particle.
+ * In deterministic mode, the default, every operation of
+ * Physics::integrateMotion is done in the same order and rounded the same
+ * way: the results are the same to the bit, whatever the instructions.
+ * Otherwise multiplications and additions are fused where the processor
+ * can, which is faster but rounds differently.
+ * It pays off for particles kept in a batch from one step to the next:
+ * copying Particle components in and out costs more than the integration
+ * saves, PhysicsSystem integrates them in place instead.
+ */
+class ParticleBatch {
+ public:
+  // instructions the integration runs with
+  enum class Isa : std::uint8_t { SCALAR, SSE2, AVX2, AVX2_FMA };
+
+  /**
+   * @brief the widest instructions the processor supports, fused or not
+   */
+  static Isa best(bool deterministic);
+
+  /**
+   * @brief add a particle, static ones must be left out
+   */
+  void push(Particle const& p);
+
+  /**
+   * @brief move every particle by one step of dt seconds
+   */
+  void integrate(double dt);
+
+  /**
+   * @brief copy the state of the i-th particle back, its forces belong to
+   * the batch once pushed
+   */
+  void store(std::size_t i, Particle& p) const;
+
+  vector_t position(std::size_t i) const {
+    return vector_t(_px[i], _py[i], _pz[i]);
+  }
+  vector_t velocity(std::size_t i) const {
+    return vector_t(_vx[i], _vy[i], _vz[i]);
+  }
+
+  std::size_t size() const { return _px.size(); }
+
+  /**
+   * @brief forget the particles, keep the storage
+   */
+  void clear();
+
+  void reserve(std::size_t count);
+
+  /**
+   * @brief whether the results must be those of Physics::integrateMotion
+   */
+  void setDeterministic(bool deterministic) {
+    _isa = best(deterministic);
+  }
+
+  /**
+   * @brief force the instructions, for tests and benchmarks; they must be
+   * supported
+   */
+  void setIsa(Isa isa) { _isa = isa; }
+  Isa isa() const { return _isa; }
+
+ private:
+  Isa _isa = best(true);
+  std::vector<double> _px, _py, _pz;
+  std::vector<double> _vx, _vy, _vz;
+  std::vector<double> _gx, _gy, _gz;
+  // forces times the inverse of the mass, zeroed by integrate
+  std::vector<double> _fx, _fy, _fz;
+  std::vector<double> _damping;
+  // damping to the power of the step, by particle
+  std::vector<double> _factors;
+  // the last power computed, kept from one step to the next
+  double _dt = 0.;
+  double _base = 0.;
+  double _factor = 1.;
+};
+
+}  // namespace arty
+
+#endif  // PARTICLE_BATCH_HPP
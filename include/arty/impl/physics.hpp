@@ -49,7 +49,7 @@ class Particle {
   vector_t forceaccu;
   number_t damping;
   number_t restitution;
-  bool isStatic() { return _is_static; }
+  bool isStatic() const { return _is_static; }
   void setMass(number_t m) {
     if (m == 0) {
       _is_static = true;
@@ -91,6 +91,10 @@ class Particle {
 class Physics {
  public:
   void integrateMotion(Particle& p, double duration) const;
+  /**
+   * @brief same, with p.damping to the power of duration already computed
+   */
+  void integrateMotion(Particle& p, double duration, number_t factor) const;
   Collision detectCollision(Tf3f const& tf1, AABox3f const& b1, Tf3f const& tf2,
                             AABox3f const& b2);
   void resolveVelocity(Collision const& c, Particle& p1, Particle& p2,
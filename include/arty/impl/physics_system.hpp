@@ -1,6 +1,8 @@
 #ifndef PHYSICS_SYSTEM_HPP
 #define PHYSICS_SYSTEM_HPP
 
+#include <arty/core/broadphase.hpp>
+#include <arty/core/clock.hpp>
 #include <arty/core/system.hpp>
 #include <arty/impl/hitbox_rendering_system.hpp>
 #include <arty/impl/physics.hpp>
@@ -11,7 +13,10 @@ using CollisionArray = std::vector<Collision>;
 
 class CollisionRenderingSystem : public System {
  public:
-  CollisionRenderingSystem(Ptr<IShapeRenderer> rend) : _renderer(rend) {}
+  CollisionRenderingSystem(Ptr<IShapeRenderer> rend) : _renderer(rend) {
+    reads<Camera, CollisionArray>();
+    renders();
+  }
 
  private:
   Ptr<IShapeRenderer> _renderer;
@@ -23,10 +28,111 @@ class CollisionRenderingSystem : public System {
 
 class PhysicsSystem : public System {
  public:
+  PhysicsSystem() {
+    reads<AABox3f, SimulationClock>();
+    writes<Particle, Tf3f, CollisionArray>();
+    // also makes it run alone, which process relies on to advance the tick
+    // of the memory, see detectCollision and updateIslands
+    removesEntities();
+    anyThread();
+    fixedStep();
+  }
+
+  /**
+   * @brief simulate one step of the SimulationClock
+   *
+   * Without clock, steps of SimulationClock().step seconds are used.
+   */
   Result process(const Ptr<Memory>& board) override;
-  Result integrateMotion(Ptr<Memory> const& mem) const;
+
+  /**
+   * @brief find the pairs to test with another broadphase, SweepAndPrune by
+   * default
+   */
+  void setBroadphase(Ptr<IBroadphase> const& broadphase) {
+    _broadphase = broadphase;
+  }
+
+  /**
+   * @brief put to sleep the islands of bodies that barely move
+   *
+   * Bodies slower than velocity for time seconds, together with the ones
+   * they touch, are not simulated until a moving box hits them, or their
+   * Particle or box is written, or one of them is removed. A velocity of 0
+   * keeps every body awake.
+   */
+  void setSleeping(double velocity, double time);
+
+  bool asleep(Entity const& entity) const {
+    return entity.index() < _bodies.size() &&
+           _bodies[entity.index()].entity == entity &&
+           _bodies[entity.index()].island != npos;
+  }
+
+  /**
+   * @brief move the particles that are awake, static ones only when written
+   */
+  Result integrateMotion(Ptr<Memory> const& mem);
   Result resolveCollision(Ptr<Memory> const& mem) const;
-  Result detectCollision(Ptr<Memory> const& mem) const;
+  /**
+   * @brief collisions of every pair of boxes, in the CollisionArray of the
+   * lower entity
+   *
+   * Only the pairs the broadphase finds overlapping are tested. Sleeping
+   * islands written since, or that one of the collisions involves, are
+   * woken up.
+   */
+  Result detectCollision(Ptr<Memory> const& mem);
+  /**
+   * @brief group the awake bodies in contact, put to sleep the islands whose
+   * bodies all stayed slow long enough
+   */
+  Result updateIslands(Ptr<Memory> const& mem);
+  // entities below the floor are removed once per frame, in one batch
+  Result removeFallen(Ptr<Memory> const& mem);
+
+ private:
+  static constexpr std::uint32_t npos = UINT32_MAX;
+
+  struct Body {
+    Entity entity;
+    // simulated seconds spent slower than the sleep velocity
+    double still = 0.;
+    // the sleeping island it is in, npos while awake
+    std::uint32_t island = npos;
+    // in the union find of updateIslands
+    std::uint32_t node = npos;
+  };
+
+  struct Island {
+    std::vector<Entity> bodies;
+    // tick it fell asleep at, later writes wake it up
+    Tick since = 0;
+  };
+
+  // the body of an entity, a new one if its index had another owner
+  Body& body(Entity const& entity);
+  std::uint32_t root(std::uint32_t node);
+  void wake(Entity const& entity);
+  void wakeIsland(std::uint32_t island);
+
+  Tick _lastDetection = 0;
+  // kept from one step to the next, boxes barely move in between
+  Ptr<IBroadphase> _broadphase = std::make_shared<SweepAndPrune>();
+  double _step = SimulationClock().step;
+  double _sleepVelocity = 0.05;
+  double _sleepTime = 0.5;
+  // by Entity::index
+  std::vector<Body> _bodies;
+  // sleeping islands, free ones are empty
+  std::vector<Island> _islands;
+  std::vector<std::uint32_t> _freeIslands;
+  // awake bodies of the current updateIslands, their union find, and by
+  // root how long the island stayed still and where it sleeps
+  std::vector<Entity> _nodes;
+  std::vector<std::uint32_t> _parents;
+  std::vector<double> _still;
+  std::vector<std::uint32_t> _islandOf;
 };
 
 }  // namespace arty
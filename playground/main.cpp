@@ -14,34 +14,46 @@ using namespace arty;
 
 class CursorRenderingSystem : public System {
  public:
-  Result process(Ptr<Memory> const& mem);
-  CursorRenderingSystem(Ptr<IShapeRenderer> rend) : _renderer(rend) {}
+  Result init(Ptr<Memory> const& mem) override;
+  Result process(Ptr<Memory> const& mem) override;
+  CursorRenderingSystem(Ptr<IShapeRenderer> rend) : _renderer(rend) {
+    reads<Selected, Camera>();
+    // draws, so it stays on the thread owning the window once pipelined
+    renders();
+  }
 
  private:
   Ptr<IShapeRenderer> _renderer;
+  Entity _cross;
 };
 
+Result CursorRenderingSystem::init(const Ptr<Memory>& mem) {
+  // on the board, the snapshot drawn once pipelined is copied over
+  _cross = mem->createEntity("cursor");
+  return ok();
+}
+
 Result CursorRenderingSystem::process(const Ptr<Memory>& mem) {
-  Selected cursor;
-  if (!mem->read(cursor)) {
+  Selected const* cursor = mem->resource<Selected>();
+  if (!cursor) {
     return error("no cursor to display");
   }
-  Camera camera;
-  if (!mem->read(camera)) {
+  Camera const* camera = mem->resource<Camera>();
+  if (!camera) {
     return error("no camera");
   }
-  static auto cross = mem->createEntity("cursor");
-  if (cursor.entity.id() > 0) {
-    _renderer->draw(cross, Sphere3f(cursor.point, 0.2f), Mat4x4f::identity(),
-                    camera.view(), camera.projection());
+  if (cursor->entity.id() > 0) {
+    _renderer->draw(_cross, Sphere3f(cursor->point, 0.2f), Mat4x4f::identity(),
+                    camera->view(), camera->projection());
   } else {
-    _renderer->draw(cross, Sphere3f(cursor.point, 0.1f), Mat4x4f::identity(),
-                    camera.view(), camera.projection());
+    _renderer->draw(_cross, Sphere3f(cursor->point, 0.1f), Mat4x4f::identity(),
+                    camera->view(), camera->projection());
   }
   return ok();
 }
 
-int main(void) {
+// every argument is a system plugin, edited and rebuilt while it runs
+int main(int argc, char** argv) {
   GlfwWindow* window_impl = new GlfwWindow;
   Ptr<Keyboard> keyboard = window_impl->provideKeyboard();
   Ptr<Mouse> mouse = window_impl->provideMouse();
@@ -51,8 +63,8 @@ int main(void) {
   Ptr<IShapeRenderer> shapeRenderer(new GlShapeRenderer());
 
   auto AddFunc = [](Ptr<Memory> const& mem) -> Result {
-    Selected cursor;
-    if (!mem->read(cursor)) {
+    Selected const* cursor = mem->resource<Selected>();
+    if (!cursor) {
       return error("no cursor to display");
     }
     // Let's shoot
@@ -62,7 +74,7 @@ int main(void) {
     p.position = vector_t(-10, 0, 2);
     p.setMass(0.1);
     number_t strength(100);
-    vector_t tdc(cursor.point);
+    vector_t tdc(cursor->point);
     vector_t dir = (tdc - p.position).normalize();
     p.velocity = dir * strength;
     mem->write(bullet, p);
@@ -77,19 +89,25 @@ int main(void) {
   cam_sys->setTarget({0.f, 0.f, 0.f});
   cam_sys->setUpdir({0.f, 0.f, 1.f});
 
+  Ptr<Profiler> profiler(new Profiler);
+
   Engine engine;
   engine.setBoard(board)
       .setWindow(window)
       .setKeyboard(keyboard)
       .setMouse(mouse)
+      .setProfiler(profiler)
       .makeSystem<RandomBoardInitSystem>()
-      .makeSystem<DebugHidSystem>(window, textRenderer)
+      .makeSystem<DebugHidSystem>(window, textRenderer, profiler)
       .addSystem(cam_sys)
       .makeSystem<TileRenderingSystem>(shapeRenderer)
       .makeSystem<HitBoxRenderingSystem>(shapeRenderer)
       .makeSystem<MouseSystem>()
       .makeSystem<CursorRenderingSystem>(shapeRenderer)
       .makeSystem<EventSystem>(leftClick, Event("SHOOT"), AddFunc);
+  for (int i = 1; i < argc; ++i) {
+    engine.addPlugin(argv[i]);
+  }
 
   std::cout << "START: " << engine.start().message() << std::endl;
   std::cout << "RUN: " << engine.run().message() << std::endl;
@@ -42,20 +42,20 @@ void RandomBoardInitSystem::reset(Ptr<Memory> const& mem) {
 }
 
 Result TileRenderingSystem::process(const Ptr<Memory>& mem) {
-  Camera cam;
-  return_if_error(mem->read(cam));
-
-  TileBoard board;
-  return_if_error(mem->read(board));
-
-  if (mem->count<TileWire>()) {  // Tile wiring
-    auto work = [=](Entity const& e, Vec2u8 const& pos,
-                    TileWire const& wire) -> Result {
-      _renderer->draw(e, board.wire2segments(pos, wire),
-                      board.tile2tf(pos).toMat(), cam.view(), cam.projection());
-      return ok();
-    };
-    mem->process<Vec2u8, TileWire>(work);
+  Camera const* cam = mem->resource<Camera>();
+  if (!cam) {
+    return error("no camera");
+  }
+  TileBoard const* board = mem->resource<TileBoard>();
+  if (!board) {
+    return error("no board");
+  }
+
+  // Tile wiring
+  for (auto [e, pos, wire] : mem->view<Vec2u8, TileWire>()) {
+    _renderer->draw(e, board->wire2segments(pos, wire),
+                    board->tile2tf(pos).toMat(), cam->view(),
+                    cam->projection());
   }
 
   return ok();
@@ -80,7 +80,7 @@ class RandomBoardInitSystem : public System {
   void reset(Ptr<Memory> const& mem);
 
  public:
-  RandomBoardInitSystem() : _reset("RESET") {}
+  RandomBoardInitSystem() : _reset("RESET") { wakesOn(_reset); }
 
   Result process(const Ptr<Memory>& mem,
                  Ptr<InputManager> const& inputs) override {
@@ -101,7 +101,10 @@ class RandomBoardInitSystem : public System {
 
 class TileRenderingSystem : public System {
  public:
-  TileRenderingSystem(Ptr<IShapeRenderer> rend) : _renderer(rend) {}
+  TileRenderingSystem(Ptr<IShapeRenderer> rend) : _renderer(rend) {
+    reads<Camera, TileBoard, Vec2u8, TileWire>();
+    renders();
+  }
 
  private:
   Ptr<IShapeRenderer> _renderer;
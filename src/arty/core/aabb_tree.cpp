@@ -0,0 +1,401 @@
+#include <algorithm>
+#include <arty/core/aabb_tree.hpp>
+
+namespace arty {
+
+namespace {
+
+Vec3f lower(Vec3f const& a, Vec3f const& b) {
+  return a.apply(b, [](float l, float r) { return std::min(l, r); });
+}
+
+Vec3f upper(Vec3f const& a, Vec3f const& b) {
+  return a.apply(b, [](float l, float r) { return std::max(l, r); });
+}
+
+// half of the surface of the box, the probability for a ray to cross it
+float halfArea(Vec3f const& min, Vec3f const& max) {
+  Vec3f d = max - min;
+  return d.x() * d.y() + d.y() * d.z() + d.z() * d.x();
+}
+
+}  // namespace
+
+bool AABBTree::move(Entity const& entity, AABox3f const& box) {
+  Vec3f min = box.min();
+  Vec3f max = box.max();
+  Vec3f margin = Vec3f::all(_margin);
+  std::uint32_t leaf = find(entity);
+  if (leaf == npos) {
+    std::size_t index = entity.index();
+    if (index >= _sparse.size()) {
+      _sparse.resize(index + 1, npos);
+    }
+    if (_sparse[index] != npos) {
+      // a previous owner of the index, it is gone
+      erase(_sparse[index]);
+    }
+    leaf = allocate();
+    Node& node = _nodes[leaf];
+    node.entity = entity;
+    node.min = min - margin;
+    node.max = max + margin;
+    node.round = _round;
+    _sparse[index] = leaf;
+    ++_size;
+    insertLeaf(leaf);
+    touch(leaf);
+    return true;
+  }
+  Node& node = _nodes[leaf];
+  node.round = _round;
+  if (node.min.x() <= min.x() && node.min.y() <= min.y() &&
+      node.min.z() <= min.z() && max.x() <= node.max.x() &&
+      max.y() <= node.max.y() && max.z() <= node.max.z()) {
+    return false;
+  }
+  removeLeaf(leaf);
+  _nodes[leaf].min = min - margin;
+  _nodes[leaf].max = max + margin;
+  insertLeaf(leaf);
+  touch(leaf);
+  return true;
+}
+
+bool AABBTree::remove(Entity const& entity) {
+  std::uint32_t leaf = find(entity);
+  if (leaf == npos) {
+    return false;
+  }
+  erase(leaf);
+  return true;
+}
+
+AABox3f AABBTree::fattened(Entity const& entity) const {
+  std::uint32_t leaf = find(entity);
+  if (leaf == npos) {
+    return AABox3f();
+  }
+  Node const& node = _nodes[leaf];
+  return AABox3f((node.min + node.max) * 0.5f, (node.max - node.min) * 0.5f);
+}
+
+void AABBTree::sweep() {
+  for (std::uint32_t n = 0; n < _nodes.size(); ++n) {
+    if (_nodes[n].height == 0 && _nodes[n].round != _round) {
+      erase(n);
+    }
+  }
+  if (!_dirty.empty()) {
+    // the pairs of the leaves that were inserted or removed are searched
+    // again, the others did not change
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < _leaves.size(); ++i) {
+      if (!_nodes[_leaves[i].first].dirty &&
+          !_nodes[_leaves[i].second].dirty) {
+        _leaves[kept] = _leaves[i];
+        _pairs[kept] = _pairs[i];
+        ++kept;
+      }
+    }
+    _leaves.resize(kept);
+    _pairs.resize(kept);
+    for (std::uint32_t n : _dirty) {
+      Node const& node = _nodes[n];
+      // removed, or used again as an inner node
+      if (node.height != 0) {
+        continue;
+      }
+      visit(
+          [&node](Node const& other) {
+            return node.min.x() <= other.max.x() &&
+                   other.min.x() <= node.max.x() &&
+                   node.min.y() <= other.max.y() &&
+                   other.min.y() <= node.max.y() &&
+                   node.min.z() <= other.max.z() &&
+                   other.min.z() <= node.max.z();
+          },
+          [&](std::uint32_t other) {
+            // a pair of two inserted leaves is found from the first one
+            if (other == n || (_nodes[other].dirty && other < n)) {
+              return;
+            }
+            Entity a = node.entity;
+            Entity b = _nodes[other].entity;
+            _pairs.emplace_back(std::min(a, b), std::max(a, b));
+            _leaves.emplace_back(n, other);
+          });
+    }
+    for (std::uint32_t n : _dirty) {
+      _nodes[n].dirty = false;
+    }
+    _dirty.clear();
+  }
+  ++_round;
+}
+
+void AABBTree::clear() {
+  _nodes.clear();
+  _free.clear();
+  _root = npos;
+  _size = 0;
+  _sparse.clear();
+  _dirty.clear();
+  _pairs.clear();
+  _leaves.clear();
+}
+
+float AABBTree::cost() const {
+  float sum = 0.f;
+  for (Node const& node : _nodes) {
+    if (node.height > 0) {
+      sum += halfArea(node.min, node.max);
+    }
+  }
+  return sum;
+}
+
+bool AABBTree::valid() const {
+  if (_root == npos) {
+    return _size == 0;
+  }
+  if (_nodes[_root].parent != npos) {
+    return false;
+  }
+  std::size_t leaves = 0;
+  std::vector<std::uint32_t> stack{_root};
+  while (!stack.empty()) {
+    std::uint32_t n = stack.back();
+    stack.pop_back();
+    Node const& node = _nodes[n];
+    if (node.leaf()) {
+      ++leaves;
+      if (node.height != 0 || node.right != npos ||
+          _sparse[node.entity.index()] != n) {
+        return false;
+      }
+      continue;
+    }
+    Node const& left = _nodes[node.left];
+    Node const& right = _nodes[node.right];
+    if (left.parent != n || right.parent != n ||
+        node.height != 1 + std::max(left.height, right.height) ||
+        lower(left.min, right.min) != node.min ||
+        upper(left.max, right.max) != node.max) {
+      return false;
+    }
+    stack.push_back(node.left);
+    stack.push_back(node.right);
+  }
+  return leaves == _size;
+}
+
+bool AABBTree::crosses(Vec3f const& origin, Vec3f const& inverse,
+                       std::uint32_t node, float length, float& enter) const {
+  Node const& n = _nodes[node];
+  float lo = 0.f;
+  float hi = length;
+  for (std::size_t axis = 0; axis < 3; ++axis) {
+    float t1 = (n.min[axis] - origin[axis]) * inverse[axis];
+    float t2 = (n.max[axis] - origin[axis]) * inverse[axis];
+    // NaN for a ray in the plane of a side, which does not restrict it
+    lo = std::fmax(lo, std::fmin(t1, t2));
+    hi = std::fmin(hi, std::fmax(t1, t2));
+  }
+  enter = lo;
+  return lo <= hi;
+}
+
+std::uint32_t AABBTree::find(Entity const& entity) const {
+  std::size_t index = entity.index();
+  if (index >= _sparse.size() || _sparse[index] == npos ||
+      _nodes[_sparse[index]].entity != entity) {
+    return npos;
+  }
+  return _sparse[index];
+}
+
+std::uint32_t AABBTree::allocate() {
+  std::uint32_t n;
+  if (_free.empty()) {
+    n = static_cast<std::uint32_t>(_nodes.size());
+    _nodes.emplace_back();
+  } else {
+    n = _free.back();
+    _free.pop_back();
+  }
+  // a removed leaf keeps being dirty until the next sweep
+  bool dirty = _nodes[n].dirty;
+  _nodes[n] = Node();
+  _nodes[n].dirty = dirty;
+  _nodes[n].height = 0;
+  return n;
+}
+
+void AABBTree::release(std::uint32_t node) {
+  Node& n = _nodes[node];
+  n.parent = npos;
+  n.left = npos;
+  n.right = npos;
+  n.height = -1;
+  _free.push_back(node);
+}
+
+void AABBTree::insertLeaf(std::uint32_t leaf) {
+  if (_root == npos) {
+    _root = leaf;
+    _nodes[leaf].parent = npos;
+    return;
+  }
+  // go down while pairing the leaf with a child costs less than with the
+  // node: the boxes of every node on the way grow, that cost is inherited
+  std::uint32_t sibling = _root;
+  while (!_nodes[sibling].leaf()) {
+    Node const& node = _nodes[sibling];
+    float combined = area(sibling, leaf);
+    float cost = 2.f * combined;
+    float inherited = 2.f * (combined - area(sibling));
+    auto descend = [&](std::uint32_t child) {
+      float c = area(child, leaf) + inherited;
+      return _nodes[child].leaf() ? c : c - area(child);
+    };
+    float left = descend(node.left);
+    float right = descend(node.right);
+    if (cost < left && cost < right) {
+      break;
+    }
+    sibling = left < right ? node.left : node.right;
+  }
+  std::uint32_t old = _nodes[sibling].parent;
+  std::uint32_t parent = allocate();
+  Node& p = _nodes[parent];
+  p.parent = old;
+  p.left = sibling;
+  p.right = leaf;
+  _nodes[sibling].parent = parent;
+  _nodes[leaf].parent = parent;
+  if (old == npos) {
+    _root = parent;
+  } else if (_nodes[old].left == sibling) {
+    _nodes[old].left = parent;
+  } else {
+    _nodes[old].right = parent;
+  }
+  refitUp(parent);
+}
+
+void AABBTree::removeLeaf(std::uint32_t leaf) {
+  if (leaf == _root) {
+    _root = npos;
+    return;
+  }
+  std::uint32_t parent = _nodes[leaf].parent;
+  std::uint32_t grand = _nodes[parent].parent;
+  std::uint32_t sibling = _nodes[parent].left == leaf ? _nodes[parent].right
+                                                      : _nodes[parent].left;
+  _nodes[sibling].parent = grand;
+  if (grand == npos) {
+    _root = sibling;
+  } else if (_nodes[grand].left == parent) {
+    _nodes[grand].left = sibling;
+  } else {
+    _nodes[grand].right = sibling;
+  }
+  release(parent);
+  _nodes[leaf].parent = npos;
+  if (grand != npos) {
+    refitUp(grand);
+  }
+}
+
+void AABBTree::erase(std::uint32_t leaf) {
+  removeLeaf(leaf);
+  _sparse[_nodes[leaf].entity.index()] = npos;
+  release(leaf);
+  touch(leaf);
+  --_size;
+}
+
+void AABBTree::refitUp(std::uint32_t node) {
+  while (node != npos) {
+    refit(node);
+    rotate(node);
+    node = _nodes[node].parent;
+  }
+}
+
+void AABBTree::refit(std::uint32_t node) {
+  Node& n = _nodes[node];
+  Node const& left = _nodes[n.left];
+  Node const& right = _nodes[n.right];
+  n.min = lower(left.min, right.min);
+  n.max = upper(left.max, right.max);
+  n.height = 1 + std::max(left.height, right.height);
+}
+
+void AABBTree::rotate(std::uint32_t node) {
+  Node const& n = _nodes[node];
+  if (n.height < 2) {
+    return;
+  }
+  // putting a child in place of a grandchild under the other child only
+  // changes the box of that other child: keep the smallest one
+  float best = 0.f;
+  std::uint32_t child = npos;
+  std::uint32_t grandchild = npos;
+  auto consider = [&](std::uint32_t c, std::uint32_t other) {
+    Node const& o = _nodes[other];
+    if (o.leaf()) {
+      return;
+    }
+    float before = area(other);
+    float gain = before - area(c, o.right);
+    if (gain > best) {
+      best = gain;
+      child = c;
+      grandchild = o.left;
+    }
+    gain = before - area(c, o.left);
+    if (gain > best) {
+      best = gain;
+      child = c;
+      grandchild = o.right;
+    }
+  };
+  consider(n.left, n.right);
+  consider(n.right, n.left);
+  if (child != npos) {
+    swap(child, grandchild);
+  }
+}
+
+void AABBTree::swap(std::uint32_t child, std::uint32_t grandchild) {
+  std::uint32_t node = _nodes[child].parent;
+  std::uint32_t other = _nodes[grandchild].parent;
+  Node& n = _nodes[node];
+  (n.left == child ? n.left : n.right) = grandchild;
+  Node& o = _nodes[other];
+  (o.left == grandchild ? o.left : o.right) = child;
+  _nodes[grandchild].parent = node;
+  _nodes[child].parent = other;
+  refit(other);
+  refit(node);
+}
+
+void AABBTree::touch(std::uint32_t leaf) {
+  if (!_nodes[leaf].dirty) {
+    _nodes[leaf].dirty = true;
+    _dirty.push_back(leaf);
+  }
+}
+
+float AABBTree::area(std::uint32_t a, std::uint32_t b) const {
+  return halfArea(lower(_nodes[a].min, _nodes[b].min),
+                  upper(_nodes[a].max, _nodes[b].max));
+}
+
+float AABBTree::area(std::uint32_t node) const {
+  return halfArea(_nodes[node].min, _nodes[node].max);
+}
+
+}  // namespace arty
@@ -0,0 +1,262 @@
+#include <algorithm>
+#include <arty/core/broadphase.hpp>
+#include <limits>
+
+namespace arty {
+
+namespace {
+
+std::uint64_t key(std::uint32_t a, std::uint32_t b) {
+  if (a > b) {
+    std::swap(a, b);
+  }
+  return static_cast<std::uint64_t>(a) << 32 | b;
+}
+
+}  // namespace
+
+void SweepAndPrune::update(Entity const& entity, AABox3f const& box) {
+  std::size_t index = entity.index();
+  if (index >= _sparse.size()) {
+    _sparse.resize(index + 1, npos);
+  }
+  std::uint32_t p = _sparse[index];
+  if (p == npos || _proxies[p].entity != entity) {
+    // a previous owner of the index goes away with the next sweep
+    if (_free.empty()) {
+      p = static_cast<std::uint32_t>(_proxies.size());
+      _proxies.emplace_back();
+    } else {
+      p = _free.back();
+      _free.pop_back();
+    }
+    _sparse[index] = p;
+    _proxies[p].entity = entity;
+    _added.push_back(p);
+  }
+  Proxy& proxy = _proxies[p];
+  proxy.min = box.min();
+  proxy.max = box.max();
+  proxy.round = _round;
+  store(p);
+}
+
+void SweepAndPrune::sweep() {
+  // boxes that were not updated are gone: sent to infinity, they end up at
+  // the end of the axes where they are cut off
+  float const inf = std::numeric_limits<float>::infinity();
+  bool removed = false;
+  for (std::uint32_t p = 0; p < _proxies.size(); ++p) {
+    Proxy& proxy = _proxies[p];
+    if (proxy.round != 0 && proxy.round != _round) {
+      proxy.min = Vec3f::all(inf);
+      proxy.max = Vec3f::all(inf);
+      store(p);
+      removed = true;
+    }
+  }
+  bool scratch = _added.size() * 8 > size();
+  if (scratch) {
+    for (std::uint32_t p : _added) {
+      Proxy& proxy = _proxies[p];
+      for (std::size_t axis = 0; axis < 3; ++axis) {
+        _bounds[axis].push_back(Bound{proxy.min[axis], p << 1});
+        _bounds[axis].push_back(Bound{proxy.max[axis], p << 1 | 1});
+      }
+      proxy.placed = true;
+    }
+    _added.clear();
+  }
+  for (std::size_t axis = 0; axis < 3; ++axis) {
+    auto& bounds = _bounds[axis];
+    if (scratch) {
+      std::sort(bounds.begin(), bounds.end(), before);
+      index(axis);
+    } else {
+      sort(axis);
+    }
+    while (!bounds.empty() && !alive(bounds.back().data >> 1)) {
+      bounds.pop_back();
+    }
+  }
+  if (removed) {
+    // two removed boxes touch at infinity, their pair is still there
+    for (std::size_t i = 0; i < _keys.size();) {
+      auto a = static_cast<std::uint32_t>(_keys[i] >> 32);
+      auto b = static_cast<std::uint32_t>(_keys[i]);
+      if (alive(a) && alive(b)) {
+        ++i;
+      } else {
+        erase(i);
+      }
+    }
+    for (std::uint32_t p = 0; p < _proxies.size(); ++p) {
+      Proxy& proxy = _proxies[p];
+      if (proxy.round != 0 && proxy.round != _round) {
+        if (_sparse[proxy.entity.index()] == p) {
+          _sparse[proxy.entity.index()] = npos;
+        }
+        proxy.round = 0;
+        proxy.placed = false;
+        _free.push_back(p);
+      }
+    }
+  }
+  if (scratch) {
+    rebuild();
+  } else if (!_added.empty()) {
+    for (std::uint32_t p : _added) {
+      insert(p);
+    }
+    _added.clear();
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      index(axis);
+    }
+  }
+  ++_round;
+}
+
+void SweepAndPrune::clear() {
+  _proxies.clear();
+  _free.clear();
+  _sparse.clear();
+  _added.clear();
+  for (auto& bounds : _bounds) {
+    bounds.clear();
+  }
+  _pairs.clear();
+  _keys.clear();
+  _indices.clear();
+}
+
+bool SweepAndPrune::overlap(std::uint32_t a, std::uint32_t b) const {
+  Proxy const& pa = _proxies[a];
+  Proxy const& pb = _proxies[b];
+  return pa.min.x() <= pb.max.x() && pb.min.x() <= pa.max.x() &&
+         pa.min.y() <= pb.max.y() && pb.min.y() <= pa.max.y() &&
+         pa.min.z() <= pb.max.z() && pb.min.z() <= pa.max.z();
+}
+
+void SweepAndPrune::store(std::uint32_t p) {
+  Proxy const& proxy = _proxies[p];
+  if (!proxy.placed) {
+    return;
+  }
+  for (std::size_t axis = 0; axis < 3; ++axis) {
+    _bounds[axis][proxy.at[2 * axis]].value = proxy.min[axis];
+    _bounds[axis][proxy.at[2 * axis + 1]].value = proxy.max[axis];
+  }
+}
+
+void SweepAndPrune::index(std::size_t axis) {
+  auto const& bounds = _bounds[axis];
+  for (std::size_t i = 0; i < bounds.size(); ++i) {
+    Bound const& bound = bounds[i];
+    _proxies[bound.data >> 1].at[2 * axis + (bound.data & 1)] =
+        static_cast<std::uint32_t>(i);
+  }
+}
+
+void SweepAndPrune::sort(std::size_t axis) {
+  auto& bounds = _bounds[axis];
+  for (std::size_t i = 1; i < bounds.size(); ++i) {
+    if (!before(bounds[i], bounds[i - 1])) {
+      continue;
+    }
+    Bound bound = bounds[i];
+    std::size_t j = i;
+    for (; j > 0 && before(bound, bounds[j - 1]); --j) {
+      Bound const& other = bounds[j - 1];
+      bool upper = bound.data & 1;
+      if (upper != static_cast<bool>(other.data & 1)) {
+        std::uint32_t a = bound.data >> 1;
+        std::uint32_t b = other.data >> 1;
+        if (upper) {
+          // separated on this axis
+          drop(a, b);
+        } else if (overlap(a, b)) {
+          // overlapping on this axis, and maybe on the others
+          add(a, b);
+        }
+      }
+      bounds[j] = other;
+      _proxies[other.data >> 1].at[2 * axis + (other.data & 1)] =
+          static_cast<std::uint32_t>(j);
+    }
+    bounds[j] = bound;
+    _proxies[bound.data >> 1].at[2 * axis + (bound.data & 1)] =
+        static_cast<std::uint32_t>(j);
+  }
+}
+
+void SweepAndPrune::insert(std::uint32_t p) {
+  Proxy& proxy = _proxies[p];
+  // positions are set once every box is inserted
+  proxy.placed = true;
+  for (std::size_t axis = 0; axis < 3; ++axis) {
+    auto& bounds = _bounds[axis];
+    for (Bound bound : {Bound{proxy.min[axis], p << 1},
+                        Bound{proxy.max[axis], p << 1 | 1}}) {
+      bounds.insert(
+          std::upper_bound(bounds.begin(), bounds.end(), bound, before),
+          bound);
+    }
+  }
+  for (std::uint32_t q = 0; q < _proxies.size(); ++q) {
+    if (q != p && alive(q) && overlap(p, q)) {
+      add(p, q);
+    }
+  }
+}
+
+void SweepAndPrune::rebuild() {
+  _pairs.clear();
+  _keys.clear();
+  _indices.clear();
+  // boxes overlapping on the first axis are found in one pass over it
+  std::vector<std::uint32_t> open;
+  for (Bound const& bound : _bounds[0]) {
+    std::uint32_t p = bound.data >> 1;
+    if (bound.data & 1) {
+      open.erase(std::find(open.begin(), open.end(), p));
+      continue;
+    }
+    for (std::uint32_t q : open) {
+      if (overlap(p, q)) {
+        add(p, q);
+      }
+    }
+    open.push_back(p);
+  }
+}
+
+void SweepAndPrune::add(std::uint32_t a, std::uint32_t b) {
+  std::uint64_t k = key(a, b);
+  if (!_indices.emplace(k, _pairs.size()).second) {
+    return;
+  }
+  Entity ea = _proxies[a].entity;
+  Entity eb = _proxies[b].entity;
+  _pairs.emplace_back(std::min(ea, eb), std::max(ea, eb));
+  _keys.push_back(k);
+}
+
+void SweepAndPrune::drop(std::uint32_t a, std::uint32_t b) {
+  auto it = _indices.find(key(a, b));
+  if (it != _indices.end()) {
+    erase(it->second);
+  }
+}
+
+void SweepAndPrune::erase(std::size_t index) {
+  _indices.erase(_keys[index]);
+  if (index + 1 != _pairs.size()) {
+    _pairs[index] = _pairs.back();
+    _keys[index] = _keys.back();
+    _indices[_keys[index]] = index;
+  }
+  _pairs.pop_back();
+  _keys.pop_back();
+}
+
+}  // namespace arty
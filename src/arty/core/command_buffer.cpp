@@ -0,0 +1,25 @@
+#include <arty/core/command_buffer.hpp>
+
+namespace arty {
+
+void CommandBuffer::flush(Memory& mem) {
+  std::vector<Command> commands;
+  std::swap(commands, _commands);
+  std::vector<Entity> removed;
+  for (auto const& command : commands) {
+    if (!command.apply) {
+      removed.push_back(command.removed);
+      continue;
+    }
+    if (!removed.empty()) {
+      mem.removeAll(removed);
+      removed.clear();
+    }
+    command.apply(mem);
+  }
+  if (!removed.empty()) {
+    mem.removeAll(removed);
+  }
+}
+
+}  // namespace arty
@@ -0,0 +1,78 @@
+#include <arty/core/component_registry.hpp>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#ifdef __GNUG__
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+
+namespace arty {
+
+namespace {
+
+struct Names {
+  std::mutex mutex;
+  // deque keeps the returned references valid when types are added
+  std::deque<std::string> names;
+  std::vector<std::type_info const*> types;
+};
+
+Names& names() {
+  static Names instance;
+  return instance;
+}
+
+}  // namespace
+
+std::string demangle(char const* mangled) {
+#ifdef __GNUG__
+  int status = 0;
+  std::unique_ptr<char, void (*)(void*)> res(
+      abi::__cxa_demangle(mangled, nullptr, nullptr, &status), std::free);
+  if (status == 0) {
+    return res.get();
+  }
+#endif
+  return mangled;
+}
+
+ComponentId ComponentRegistry::add(std::type_info const& type) {
+  auto& reg = names();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  // a plugin has its own instance of Type<T>, but must share the id of T
+  for (std::size_t id = 0; id < reg.types.size(); ++id) {
+    if (*reg.types[id] == type) {
+      return id;
+    }
+  }
+  if (reg.names.size() >= MAX_COMPONENTS) {
+    // the memory indexes flat tables with the id, it cannot grow past them
+    throw std::length_error("too many component types, at most " +
+                            std::to_string(MAX_COMPONENTS) + ", adding " +
+                            demangle(type.name()));
+  }
+  reg.names.push_back(demangle(type.name()));
+  reg.types.push_back(&type);
+  return reg.names.size() - 1;
+}
+
+std::string const& ComponentRegistry::name(ComponentId id) {
+  static const std::string unknown("unknown");
+  auto& reg = names();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  if (id >= reg.names.size()) {
+    return unknown;
+  }
+  return reg.names[id];
+}
+
+std::size_t ComponentRegistry::size() {
+  auto& reg = names();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  return reg.names.size();
+}
+
+}  // namespace arty
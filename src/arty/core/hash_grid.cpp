@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <arty/core/hash_grid.hpp>
+
+namespace arty {
+
+SpatialHashGrid::SpatialHashGrid(float cellSize)
+    : _cellSize(cellSize), _inverse(1.f / cellSize) {}
+
+void SpatialHashGrid::update(Entity const& entity, AABox3f const& box) {
+  std::size_t index = entity.index();
+  if (index >= _sparse.size()) {
+    _sparse.resize(index + 1, npos);
+  }
+  std::uint32_t p = _sparse[index];
+  if (p == npos || _proxies[p].entity != entity) {
+    // a previous owner of the index goes away with the next sweep
+    if (_free.empty()) {
+      p = static_cast<std::uint32_t>(_proxies.size());
+      _proxies.emplace_back();
+    } else {
+      p = _free.back();
+      _free.pop_back();
+    }
+    _sparse[index] = p;
+    _proxies[p].entity = entity;
+  }
+  Proxy& proxy = _proxies[p];
+  proxy.min = box.min();
+  proxy.max = box.max();
+  proxy.round = _round;
+}
+
+void SpatialHashGrid::sweep() {
+  for (std::uint32_t p = 0; p < _proxies.size(); ++p) {
+    Proxy& proxy = _proxies[p];
+    if (proxy.round != 0 && proxy.round != _round) {
+      if (_sparse[proxy.entity.index()] == p) {
+        _sparse[proxy.entity.index()] = npos;
+      }
+      proxy.round = 0;
+      _free.push_back(p);
+    }
+  }
+  if (_table.empty()) {
+    _table.resize(std::size_t(1) << (64 - _shift));
+  }
+  while (!fill()) {
+    _table.assign(_table.size() * 2, Slot());
+    --_shift;
+  }
+  std::size_t chunks = _pool ? 4 * _pool->size() : 1;
+  if (_found.size() < chunks) {
+    _found.resize(chunks);
+  }
+  if (chunks > 1) {
+    _pool->parallelFor(chunks,
+                       [this, chunks](std::size_t c) { collect(c, chunks); });
+  } else {
+    collect(0, 1);
+  }
+  // merged in order, the pairs do not depend on the threads
+  _pairs.clear();
+  for (std::size_t c = 0; c < chunks; ++c) {
+    _pairs.insert(_pairs.end(), _found[c].begin(), _found[c].end());
+  }
+  for (std::uint32_t l : _large) {
+    for (std::uint32_t p = 0; p < _proxies.size(); ++p) {
+      Proxy const& proxy = _proxies[p];
+      // two large boxes are tested once
+      if (p == l || proxy.round != _round || (proxy.large && p < l) ||
+          !overlap(l, p)) {
+        continue;
+      }
+      Entity a = _proxies[l].entity;
+      _pairs.emplace_back(std::min(a, proxy.entity),
+                          std::max(a, proxy.entity));
+    }
+  }
+  ++_round;
+}
+
+void SpatialHashGrid::clear() {
+  _proxies.clear();
+  _free.clear();
+  _sparse.clear();
+  _table.clear();
+  _shift = 64 - 10;
+  _used.clear();
+  _cells.clear();
+  _entries.clear();
+  _large.clear();
+  _found.clear();
+  _pairs.clear();
+}
+
+std::int32_t SpatialHashGrid::cell(float value) const {
+  // std::floor is a call without SSE4.1
+  float scaled = value * _inverse;
+  auto truncated = static_cast<std::int32_t>(scaled);
+  return truncated - (scaled < static_cast<float>(truncated));
+}
+
+bool SpatialHashGrid::overlap(std::uint32_t a, std::uint32_t b) const {
+  Proxy const& pa = _proxies[a];
+  Proxy const& pb = _proxies[b];
+  return pa.min.x() <= pb.max.x() && pb.min.x() <= pa.max.x() &&
+         pa.min.y() <= pb.max.y() && pb.min.y() <= pa.max.y() &&
+         pa.min.z() <= pb.max.z() && pb.min.z() <= pa.max.z();
+}
+
+std::uint64_t SpatialHashGrid::key(std::int32_t x, std::int32_t y,
+                                   std::int32_t z) {
+  std::uint64_t const mask = (1u << 21) - 1;
+  return (static_cast<std::uint64_t>(x) & mask) |
+         (static_cast<std::uint64_t>(y) & mask) << 21 |
+         (static_cast<std::uint64_t>(z) & mask) << 42;
+}
+
+std::uint32_t SpatialHashGrid::slot(std::uint64_t k) {
+  std::size_t mask = _table.size() - 1;
+  // Fibonacci hashing, the high bits of the product are the best mixed
+  std::size_t h = (k * 0x9E3779B97F4A7C15ull) >> _shift;
+  while (true) {
+    Slot& s = _table[h];
+    if (s.round != _round) {
+      // kept at most half full, probes stay short
+      if (2 * _used.size() >= _table.size()) {
+        return npos;
+      }
+      s.key = k;
+      s.round = _round;
+      s.count = 0;
+      _used.push_back(static_cast<std::uint32_t>(h));
+      return static_cast<std::uint32_t>(h);
+    }
+    if (s.key == k) {
+      return static_cast<std::uint32_t>(h);
+    }
+    h = (h + 1) & mask;
+  }
+}
+
+bool SpatialHashGrid::fill() {
+  _used.clear();
+  _cells.clear();
+  _large.clear();
+  // count the boxes of each cell
+  for (std::uint32_t p = 0; p < _proxies.size(); ++p) {
+    Proxy& proxy = _proxies[p];
+    if (proxy.round != _round) {
+      continue;
+    }
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      proxy.lower[axis] = cell(proxy.min[axis]);
+      proxy.upper[axis] = cell(proxy.max[axis]);
+    }
+    std::int64_t count = 1;
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      count *= proxy.upper[axis] - proxy.lower[axis] + 1;
+    }
+    proxy.large = count > LARGE;
+    if (proxy.large) {
+      _large.push_back(p);
+      continue;
+    }
+    for (std::int32_t x = proxy.lower[0]; x <= proxy.upper[0]; ++x) {
+      for (std::int32_t y = proxy.lower[1]; y <= proxy.upper[1]; ++y) {
+        for (std::int32_t z = proxy.lower[2]; z <= proxy.upper[2]; ++z) {
+          std::uint32_t s = slot(key(x, y, z));
+          if (s == npos) {
+            return false;
+          }
+          ++_table[s].count;
+          _cells.push_back(s);
+        }
+      }
+    }
+  }
+  // then place them, the cells being one after the other
+  std::uint32_t offset = 0;
+  for (std::uint32_t s : _used) {
+    _table[s].start = offset;
+    offset += _table[s].count;
+    _table[s].count = 0;
+  }
+  _entries.resize(offset);
+  std::size_t k = 0;
+  for (std::uint32_t p = 0; p < _proxies.size(); ++p) {
+    Proxy const& proxy = _proxies[p];
+    if (proxy.round != _round || proxy.large) {
+      continue;
+    }
+    std::int64_t count = 1;
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      count *= proxy.upper[axis] - proxy.lower[axis] + 1;
+    }
+    for (std::int64_t i = 0; i < count; ++i) {
+      Slot& s = _table[_cells[k++]];
+      _entries[s.start + s.count++] = p;
+    }
+  }
+  return true;
+}
+
+void SpatialHashGrid::collect(std::size_t chunk, std::size_t chunks) {
+  auto& found = _found[chunk];
+  found.clear();
+  std::size_t begin = _used.size() * chunk / chunks;
+  std::size_t end = _used.size() * (chunk + 1) / chunks;
+  for (std::size_t i = begin; i < end; ++i) {
+    Slot const& s = _table[_used[i]];
+    std::uint32_t const* boxes = _entries.data() + s.start;
+    for (std::uint32_t a = 0; a < s.count; ++a) {
+      for (std::uint32_t b = a + 1; b < s.count; ++b) {
+        if (!overlap(boxes[a], boxes[b])) {
+          continue;
+        }
+        Proxy const& pa = _proxies[boxes[a]];
+        Proxy const& pb = _proxies[boxes[b]];
+        // the lower corner of the overlap is in a single cell, both boxes
+        // are in it
+        if (key(cell(std::max(pa.min.x(), pb.min.x())),
+                cell(std::max(pa.min.y(), pb.min.y())),
+                cell(std::max(pa.min.z(), pb.min.z()))) != s.key) {
+          continue;
+        }
+        found.emplace_back(std::min(pa.entity, pb.entity),
+                           std::max(pa.entity, pb.entity));
+      }
+    }
+  }
+}
+
+}  // namespace arty
@@ -0,0 +1,17 @@
+#include <arty/core/headless_window.hpp>
+
+namespace arty {
+
+Result HeadlessWindow::init() {
+  _start = std::chrono::steady_clock::now();
+  _open = true;
+  return ok();
+}
+
+double HeadlessWindow::getTime() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       _start)
+      .count();
+}
+
+}  // namespace arty
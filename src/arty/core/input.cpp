@@ -8,7 +8,7 @@ void Device::process(int key, Action const& action) {
   auto const& submapping = mapping_[key];
   auto it = submapping.find(action);
   if (it != submapping.end()) {
-    _incomings.insert(it->second);
+    raise(it->second);
   }
 }
 
@@ -23,12 +23,37 @@ Device::event_t Device::generate(const std::string& name) {
 }
 
 void Device::flush() {
-  std::swap(_pool, _incomings);
+  for (int uuid : _fired) {
+    _flags[uuid] = false;
+  }
+  _fired.clear();
+  for (int uuid : _incomings) {
+    if (static_cast<std::size_t>(uuid) >= _flags.size()) {
+      _flags.resize(uuid + 1, false);
+    }
+    if (!_flags[uuid]) {
+      _flags[uuid] = true;
+      _fired.push_back(uuid);
+    }
+  }
   _incomings.clear();
 }
 
-bool Device::occured(Device::event_t const& e) {
-  return _pool.find(e) != _pool.end();
+void Device::merge(Device const& other) {
+  for (int uuid : other._fired) {
+    if (static_cast<std::size_t>(uuid) >= _flags.size()) {
+      _flags.resize(uuid + 1, false);
+    }
+    if (!_flags[uuid]) {
+      _flags[uuid] = true;
+      _fired.push_back(uuid);
+    }
+  }
+}
+
+bool Device::occured(Device::event_t const& e) const {
+  auto uuid = static_cast<std::size_t>(e.uuid());
+  return uuid < _flags.size() && _flags[uuid];
 }
 
 bool InputManager::attach(const Input& in, const Event& ev) {
@@ -58,21 +83,29 @@ bool InputManager::attach(const Mouse::Button& key,
 }
 
 bool InputManager::pop(const Event& event) {
-  if (!_mouse && !_keyboard) {
-    return false;
-  }
-  if (!_mouse) {
-    return _keyboard->occured(event);
+  return _bus.occured(event) || (_mouse && _mouse->occured(event)) ||
+         (_keyboard && _keyboard->occured(event));
+}
+
+void InputManager::emit(const Event& event) {
+  std::lock_guard<std::mutex> lock(_emitting);
+  _bus.raise(event);
+}
+
+void InputManager::fired(std::vector<int>& uuids) const {
+  uuids.insert(uuids.end(), _bus.fired().begin(), _bus.fired().end());
+  if (_mouse) {
+    uuids.insert(uuids.end(), _mouse->fired().begin(), _mouse->fired().end());
   }
-  if (!_keyboard) {
-    return _mouse->occured(event);
+  if (_keyboard) {
+    uuids.insert(uuids.end(), _keyboard->fired().begin(),
+                 _keyboard->fired().end());
   }
-  return _mouse->occured(event) || _keyboard->occured(event);
 }
 
 Mouse::position_type InputManager::position() const {
   if (!_mouse) {
-    return Mouse::position_type();
+    return _position;
   }
   return _mouse->position();
 }
@@ -83,7 +116,26 @@ void InputManager::set(const Mouse::position_type& pos) {
   }
 }
 
+void InputManager::copyTo(InputManager& dst) const {
+  dst._mouse.reset();
+  dst._keyboard.reset();
+  dst._bus = Device();
+  // only flush changes the events of the frame, emit does not
+  dst._bus.merge(_bus);
+  if (_mouse) {
+    dst._bus.merge(*_mouse);
+  }
+  if (_keyboard) {
+    dst._bus.merge(*_keyboard);
+  }
+  dst._position = position();
+}
+
 void InputManager::flush() {
+  {
+    std::lock_guard<std::mutex> lock(_emitting);
+    _bus.flush();
+  }
   if (_mouse) {
     _mouse->flush();
   }
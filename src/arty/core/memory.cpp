@@ -1,6 +1,197 @@
+#include <algorithm>
 #include <arty/core/memory.hpp>
 
 namespace arty {
-uint64_t Entity::_count = 0;
+
+Entity Memory::createEntity(std::string const& name) {
+  std::lock_guard<std::shared_mutex> lock(_structure);
+  Entity::index_type index;
+  if (_free.empty()) {
+    index = static_cast<Entity::index_type>(_generations.size());
+    _generations.push_back(0);
+    _signatures.emplace_back();
+  } else {
+    index = _free.back();
+    _free.pop_back();
+  }
+  if (!name.empty()) {
+    if (index >= _names.size()) {
+      _names.resize(index + 1);
+    }
+    _names[index] = name;
+  } else if (index < _names.size()) {
+    _names[index].clear();
+  }
+  return Entity(index, _generations[index]);
+}
+
+bool Memory::isAlive(Entity const& entity) const {
+  std::shared_lock<std::shared_mutex> lock(_structure);
+  return alive(entity);
+}
+
+bool Memory::alive(Entity const& entity) const {
+  return entity && entity.index() < _generations.size() &&
+         _generations[entity.index()] == entity.generation();
+}
+
+void Memory::join(ComponentId id, IComponentPool& family) {
+  family.observe([this, id](Entity const& entity, bool member) {
+    // systems running concurrently may add to other families
+    std::lock_guard<std::shared_mutex> lock(_structure);
+    // a killed entity was cleared already, its slot may be reused
+    if (alive(entity)) {
+      _signatures[entity.index()].set(id, member);
+    }
+  });
+}
+
+std::string Memory::name(Entity const& entity) const {
+  std::shared_lock<std::shared_mutex> lock(_structure);
+  if (!alive(entity) || entity.index() >= _names.size()) {
+    return std::string();
+  }
+  return _names[entity.index()];
+}
+
+bool Memory::remove(Entity const& entity) {
+  Signature families;
+  {
+    std::lock_guard<std::shared_mutex> lock(_structure);
+    if (!alive(entity)) {
+      return false;
+    }
+    std::swap(families, _signatures[entity.index()]);
+    // a new generation makes every copy of the handle stale
+    ++_generations[entity.index()];
+    _free.push_back(entity.index());
+  }
+  // the families tell the memory about the removal, it takes the lock
+  for (ComponentId id = 0; id < _families.size(); ++id) {
+    if (families.test(id)) {
+      _families[id]->remove(entity);
+    }
+  }
+  return true;
+}
+
+std::size_t Memory::removeAll(std::vector<Entity> const& entities) {
+  std::vector<Entity> killed;
+  killed.reserve(entities.size());
+  Signature families;
+  {
+    std::lock_guard<std::shared_mutex> lock(_structure);
+    for (auto const& e : entities) {
+      if (alive(e)) {
+        killed.push_back(e);
+        families |= _signatures[e.index()];
+        // bump now so a duplicate in the batch is not counted twice
+        _signatures[e.index()].reset();
+        ++_generations[e.index()];
+        _free.push_back(e.index());
+      }
+    }
+  }
+  for (ComponentId id = 0; id < _families.size(); ++id) {
+    if (families.test(id)) {
+      _families[id]->removeAll(killed);
+    }
+  }
+  return killed.size();
+}
+
+Tick Memory::advance() {
+  ++_tick;
+  for (auto& family : _families) {
+    if (family) {
+      family->setTick(_tick);
+    }
+  }
+  return _tick;
+}
+
+void Memory::forget(Tick tick) {
+  for (auto& family : _families) {
+    if (family) {
+      family->forget(tick);
+    }
+  }
+}
+
+std::size_t Memory::count(Signature const& families) const {
+  std::size_t largest = 0;
+  for (std::size_t id = 0; id < _families.size(); ++id) {
+    if (families.test(id) && _families[id]) {
+      largest = std::max(largest, _families[id]->size());
+    }
+  }
+  return largest;
+}
+
+Tick Memory::modified(Signature const& families) const {
+  Tick last = 0;
+  for (std::size_t id = 0; id < _families.size(); ++id) {
+    if (families.test(id) && _families[id]) {
+      last = std::max(last, _families[id]->modifiedTick());
+    }
+  }
+  return last;
+}
+
+Signature Memory::signature(Entity const& entity) const {
+  std::shared_lock<std::shared_mutex> lock(_structure);
+  if (!alive(entity)) {
+    return Signature();
+  }
+  return _signatures[entity.index()];
+}
+
+void Memory::clear() {
+  for (auto& family : _families) {
+    if (family) {
+      family->clear();
+    }
+  }
+  _free.clear();
+  for (std::size_t i = _generations.size() - 1; i > 0; --i) {
+    ++_generations[i];
+    _free.push_back(static_cast<Entity::index_type>(i));
+  }
+  std::fill(_signatures.begin(), _signatures.end(), Signature());
+  _names.clear();
+  // the table keeps its size, see _resources
+  for (auto& res : _resources) {
+    res.reset();
+  }
+}
+
+void Memory::copyTo(Memory& dst, Signature const& families) const {
+  dst._generations = _generations;
+  dst._free = _free;
+  dst._signatures.resize(_signatures.size());
+  for (std::size_t i = 0; i < _signatures.size(); ++i) {
+    dst._signatures[i] = _signatures[i] & families;
+  }
+  dst._names.clear();
+  dst._tick = _tick;
+  for (std::size_t id = 0; id < MAX_COMPONENTS; ++id) {
+    auto& family = dst._families[id];
+    if (families.test(id) && _families[id]) {
+      if (!family) {
+        family = _families[id]->make();
+        dst.join(id, *family);
+      }
+      _families[id]->copyTo(*family);
+    } else {
+      family.reset();
+    }
+    if (families.test(id) && _resources[id]) {
+      _copies[id](dst._resources[id], _resources[id].get());
+      dst._copies[id] = _copies[id];
+    } else {
+      dst._resources[id].reset();
+    }
+  }
+}
 
 }  // namespace arty
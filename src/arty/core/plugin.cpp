@@ -0,0 +1,74 @@
+#include <arty/core/plugin.hpp>
+#include <dlfcn.h>
+#include <unistd.h>
+
+namespace arty {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// exported by ARTY_PLUGIN
+using Factory = System* (*)();
+char const* const FACTORY = "arty_make_system";
+
+}  // namespace
+
+Result Plugin::load() {
+  std::error_code ec;
+  auto time = fs::last_write_time(_path, ec);
+  if (ec) {
+    _error = ec.message();
+    return error_as(ErrorCode::NOT_FOUND, "plugin not found");
+  }
+  // a file being written fails until it is complete, and is modified again
+  _time = time;
+  fs::path source(_path);
+  fs::path copy = fs::temp_directory_path(ec) /
+                  (source.stem().string() + "." + std::to_string(getpid()) +
+                   "." + std::to_string(_loads++) +
+                   source.extension().string());
+  if (ec || !fs::copy_file(source, copy,
+                           fs::copy_options::overwrite_existing, ec)) {
+    _error = ec.message();
+    return error_as(ErrorCode::IO, "cannot copy plugin");
+  }
+  void* handle = dlopen(copy.c_str(), RTLD_NOW | RTLD_LOCAL);
+  // the mapping stays valid once opened
+  fs::remove(copy, ec);
+  if (!handle) {
+    _error = dlerror();
+    return error_as(ErrorCode::IO, "cannot open plugin");
+  }
+  auto factory = reinterpret_cast<Factory>(dlsym(handle, FACTORY));
+  if (!factory) {
+    _error = dlerror();
+    dlclose(handle);
+    return error_as(ErrorCode::INVALID, "no system exported by plugin");
+  }
+  // never closed from now on, see the class documentation
+  Ptr<System> system(factory());
+  if (!system) {
+    _error = "null system";
+    return error_as(ErrorCode::INVALID, "no system exported by plugin");
+  }
+  _previous = std::move(_system);
+  _system = std::move(system);
+  _error.clear();
+  return ok();
+}
+
+void Plugin::restore() {
+  if (_previous) {
+    _system = std::move(_previous);
+  }
+}
+
+bool Plugin::changed() const {
+  std::error_code ec;
+  auto time = fs::last_write_time(_path, ec);
+  // a file being replaced may be missing for a moment
+  return !ec && time != _time;
+}
+
+}  // namespace arty
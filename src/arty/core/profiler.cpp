@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <arty/core/profiler.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <new>
+
+namespace arty {
+
+namespace {
+
+thread_local std::size_t allocation_count = 0;
+
+std::uint32_t threadIndex() {
+  static std::atomic<std::uint32_t> next{0};
+  thread_local std::uint32_t index = next.fetch_add(1);
+  return index;
+}
+
+void writeString(std::ostream& os, std::string const& str) {
+  os << '"';
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      os << '\\';
+    }
+    os << c;
+  }
+  os << '"';
+}
+
+}  // namespace
+
+Profiler::Profiler(std::size_t capacity)
+    : _origin(std::chrono::steady_clock::now()) {
+  std::size_t size = 1;
+  while (size < capacity) {
+    size <<= 1;
+  }
+  _ring.reset(new Slot[size]());
+  _size = size;
+  _mask = size - 1;
+}
+
+std::uint32_t Profiler::add(std::string const& name) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto it = _indices.find(name);
+  if (it != _indices.end()) {
+    return it->second;
+  }
+  auto index = static_cast<std::uint32_t>(_names.size());
+  _names.push_back(name);
+  _indices.emplace(name, index);
+  return index;
+}
+
+std::string const& Profiler::name(std::uint32_t index) const {
+  static const std::string unknown("unknown");
+  std::lock_guard<std::mutex> lock(_mutex);
+  return index < _names.size() ? _names[index] : unknown;
+}
+
+std::int64_t Profiler::now() const {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - _origin)
+      .count();
+}
+
+ProfileSample Profiler::begin(std::uint32_t name,
+                              ProfileSample::Kind kind) const {
+  ProfileSample sample;
+  sample.name = name;
+  sample.kind = kind;
+  sample.thread = threadIndex();
+  sample.frame = frame();
+  sample.allocations = allocation_count;
+  sample.start = now();
+  return sample;
+}
+
+void Profiler::end(ProfileSample& sample, std::size_t entities) {
+  sample.duration = now() - sample.start;
+  sample.allocations = allocation_count - sample.allocations;
+  sample.entities = entities;
+  record(sample);
+}
+
+void Profiler::record(ProfileSample const& sample) {
+  // every writer gets its own slot, no lock needed
+  std::uint64_t index = _head.fetch_add(1, std::memory_order_relaxed);
+  Slot& slot = _ring[index & _mask];
+  std::uint64_t words[WORDS] = {};
+  std::memcpy(words, &sample, sizeof(sample));
+  slot.seq.store(2 * index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (std::size_t i = 0; i < WORDS; ++i) {
+    slot.words[i].store(words[i], std::memory_order_relaxed);
+  }
+  slot.seq.store(2 * index + 2, std::memory_order_release);
+}
+
+bool Profiler::read(std::uint64_t index, ProfileSample& sample) const {
+  Slot const& slot = _ring[index & _mask];
+  std::uint64_t seq = slot.seq.load(std::memory_order_acquire);
+  if (seq != 2 * index + 2) {
+    return false;
+  }
+  std::uint64_t words[WORDS];
+  for (std::size_t i = 0; i < WORDS; ++i) {
+    words[i] = slot.words[i].load(std::memory_order_relaxed);
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (slot.seq.load(std::memory_order_relaxed) != seq) {
+    return false;
+  }
+  std::memcpy(&sample, words, sizeof(sample));
+  return true;
+}
+
+std::vector<ProfileSample> Profiler::samples() const {
+  std::uint64_t head = _head.load();
+  std::uint64_t first = head > _size ? head - _size : 0;
+  std::vector<ProfileSample> res;
+  res.reserve(head - first);
+  ProfileSample sample;
+  for (std::uint64_t i = first; i < head; ++i) {
+    if (read(i, sample)) {
+      res.push_back(sample);
+    }
+  }
+  return res;
+}
+
+std::vector<Profiler::Summary> Profiler::summary(std::size_t frames) const {
+  std::uint64_t last = frame();
+  std::uint64_t first = last >= frames ? last - frames + 1 : 0;
+  static const std::size_t none = static_cast<std::size_t>(-1);
+  std::vector<Summary> res;
+  // position of each name in res
+  std::vector<std::size_t> slot;
+  std::uint64_t oldest = last;
+  for (auto const& sample : samples()) {
+    if (sample.kind != ProfileSample::PROCESS || sample.frame < first) {
+      continue;
+    }
+    oldest = std::min(oldest, sample.frame);
+    if (sample.name >= slot.size()) {
+      slot.resize(sample.name + 1, none);
+    }
+    if (slot[sample.name] == none) {
+      slot[sample.name] = res.size();
+      res.emplace_back();
+      res.back().name = name(sample.name);
+    }
+    Summary& sum = res[slot[sample.name]];
+    double ms = static_cast<double>(sample.duration) * 1e-6;
+    ++sum.calls;
+    sum.frameMs += ms;
+    sum.maxMs = std::max(sum.maxMs, ms);
+    sum.entities = std::max(sum.entities, sample.entities);
+    sum.allocations += sample.allocations;
+  }
+  // the buffer may not hold as many frames as asked
+  auto count = static_cast<double>(last - oldest + 1);
+  for (auto& sum : res) {
+    sum.frameMs /= count;
+  }
+  std::sort(res.begin(), res.end(), [](Summary const& a, Summary const& b) {
+    return a.frameMs > b.frameMs;
+  });
+  return res;
+}
+
+void Profiler::writeTrace(std::ostream& os) const {
+  static const char* kinds[] = {"init", "process", "frame"};
+  auto flags = os.flags();
+  auto precision = os.precision();
+  // microseconds, with a nanosecond resolution
+  os << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+  bool first = true;
+  for (auto const& sample : samples()) {
+    os << (first ? "\n" : ",\n") << "{\"name\":";
+    writeString(os, name(sample.name));
+    os << ",\"cat\":\"" << kinds[sample.kind] << "\",\"ph\":\"X\""
+       << ",\"ts\":" << static_cast<double>(sample.start) * 1e-3
+       << ",\"dur\":" << static_cast<double>(sample.duration) * 1e-3
+       << ",\"pid\":0,\"tid\":" << sample.thread
+       << ",\"args\":{\"frame\":" << sample.frame
+       << ",\"entities\":" << sample.entities
+       << ",\"allocations\":" << sample.allocations << "}}";
+    first = false;
+  }
+  os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  os.flags(flags);
+  os.precision(precision);
+}
+
+Result Profiler::exportTrace(std::string const& path) const {
+  std::ofstream file(path);
+  if (!file) {
+    return error_as(ErrorCode::IO, "cannot open the trace file");
+  }
+  writeTrace(file);
+  return file ? ok() : error_as(ErrorCode::IO, "cannot write the trace file");
+}
+
+std::size_t Profiler::allocations() { return allocation_count; }
+
+}  // namespace arty
+
+#ifdef ARTY_PROFILE_ALLOCATIONS
+
+void* operator new(std::size_t size) {
+  ++arty::allocation_count;
+  if (void* ptr = std::malloc(size ? size : 1)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+#endif  // ARTY_PROFILE_ALLOCATIONS
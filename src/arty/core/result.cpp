@@ -1,4 +1,68 @@
 #include <arty/core/result.hpp>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace arty {
+
+namespace {
+
+struct Repeats {
+  std::chrono::steady_clock::time_point last;
+  std::size_t skipped = 0;
+};
+
+}  // namespace
+
+std::string Result::message() const {
+  if (*this) {
+    return "ok";
+  }
+  if (!_site) {
+    return "unknown error";
+  }
+  return std::string(_site->file) + ":" + std::to_string(_site->line) + ":" +
+         _site->message;
+}
+
+void Result::panic() const {
+  if (!*this) {
+    throw std::runtime_error(message());
+  }
+}
+
+void logError(Result const& res, std::string const& detail) {
+  if (res) {
+    return;
+  }
+  static std::mutex mutex;
+  static std::unordered_map<ErrorSite const*, Repeats> sites;
+  auto now = std::chrono::steady_clock::now();
+  std::size_t skipped;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = sites.find(res.site());
+    if (it != sites.end() && now - it->second.last < std::chrono::seconds(1)) {
+      ++it->second.skipped;
+      return;
+    }
+    Repeats& repeats = sites[res.site()];
+    skipped = repeats.skipped;
+    repeats.last = now;
+    repeats.skipped = 0;
+  }
+  std::cerr << res.message();
+  if (!detail.empty()) {
+    std::cerr << ": " << detail;
+  }
+  if (skipped > 0) {
+    std::cerr << " (repeated " << skipped << " times)";
+  }
+  std::cerr << std::endl;
+}
+
+}  // namespace arty
 
 std::ostream &operator<<(std::ostream &os, const arty::Result &r) {
   os << r.message();
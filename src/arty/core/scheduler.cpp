@@ -0,0 +1,122 @@
+#include <arty/core/scheduler.hpp>
+
+namespace arty {
+
+void Scheduler::build(std::vector<Ptr<System>> const& systems) {
+  _systems = systems;
+  _stages.clear();
+  _results.assign(systems.size(), ok());
+  _names.clear();
+  _subscribers.clear();
+  _awake.assign(systems.size(), false);
+  _seen.assign(systems.size(), 0);
+  for (std::size_t i = 0; i < systems.size(); ++i) {
+    for (auto const& event : systems[i]->access().events) {
+      auto uuid = static_cast<std::size_t>(event.uuid());
+      if (uuid >= _subscribers.size()) {
+        _subscribers.resize(uuid + 1);
+      }
+      _subscribers[uuid].push_back(i);
+    }
+  }
+  if (_profiler) {
+    for (auto const& system : systems) {
+      _names.push_back(_profiler->add(system->name()));
+    }
+  }
+  std::vector<std::size_t> stage(systems.size(), 0);
+  for (std::size_t i = 0; i < systems.size(); ++i) {
+    for (std::size_t j = 0; j < i; ++j) {
+      if (stage[j] >= stage[i] &&
+          systems[j]->access().conflicts(systems[i]->access())) {
+        stage[i] = stage[j] + 1;
+      }
+    }
+    if (stage[i] >= _stages.size()) {
+      _stages.resize(stage[i] + 1);
+    }
+    _stages[stage[i]].push_back(i);
+  }
+}
+
+std::vector<Result> const& Scheduler::run(Ptr<Memory> const& mem,
+                                          Ptr<InputManager> const& inputs) {
+  if (inputs && !_subscribers.empty()) {
+    _fired.clear();
+    inputs->fired(_fired);
+    for (int uuid : _fired) {
+      if (static_cast<std::size_t>(uuid) < _subscribers.size()) {
+        for (std::size_t i : _subscribers[uuid]) {
+          _awake[i] = true;
+        }
+      }
+    }
+  }
+  for (auto const& stage : _stages) {
+    _running.clear();
+    for (std::size_t i : stage) {
+      if (awake(i, *mem)) {
+        _running.push_back(i);
+      } else {
+        _results[i] = ok();
+      }
+    }
+    if (_running.empty()) {
+      continue;
+    }
+    mem->advance();
+    bool parallel = _pool && _pool->size() > 1 && _running.size() > 1;
+    for (std::size_t i : _running) {
+      if (parallel && !_systems[i]->access().mainThread) {
+        _pool->submit([this, i, &mem, &inputs] {
+          _results[i] = process(i, mem, inputs);
+        });
+      }
+    }
+    for (std::size_t i : _running) {
+      if (!parallel || _systems[i]->access().mainThread) {
+        _results[i] = process(i, mem, inputs);
+      }
+    }
+    if (parallel) {
+      _pool->wait();
+    }
+    for (std::size_t i : _running) {
+      _systems[i]->commands().flush(*mem);
+    }
+    for (std::size_t i : _running) {
+      Access const& access = _systems[i]->access();
+      _awake[i] = false;
+      if (access.watches.any()) {
+        // includes its own modifications, they must not wake it up
+        _seen[i] = mem->modified(access.watches);
+      }
+    }
+  }
+  return _results;
+}
+
+bool Scheduler::awake(std::size_t index, Memory const& mem) const {
+  Access const& access = _systems[index]->access();
+  if (!access.sleeps() || _awake[index]) {
+    return true;
+  }
+  // compared for equality: a pipelined snapshot copies the ticks of the
+  // families but not the history of the memory tick
+  return access.watches.any() && mem.modified(access.watches) != _seen[index];
+}
+
+Result Scheduler::process(std::size_t index, Ptr<Memory> const& mem,
+                          Ptr<InputManager> const& inputs) {
+  System& system = *_systems[index];
+  if (!_profiler || index >= _names.size()) {
+    return system.process(mem, inputs);
+  }
+  auto sample = _profiler->begin(_names[index], ProfileSample::PROCESS);
+  Result res = system.process(mem, inputs);
+  Access const& access = system.access();
+  _profiler->end(sample, mem->count(access.reads | access.writes));
+  return res;
+}
+
+}  // namespace arty
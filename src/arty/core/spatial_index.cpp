@@ -0,0 +1,32 @@
+#include <arty/core/spatial_index.hpp>
+
+namespace arty {
+
+void SpatialIndex::sync(Memory const& mem) {
+  for (Entity const& e : mem.removed<Tf3f>(_since)) {
+    _tree.remove(e);
+  }
+  for (Entity const& e : mem.removed<AABox3f>(_since)) {
+    _tree.remove(e);
+  }
+  // an entity removed then given the components again is back
+  for (Entity const& e : mem.changed<Tf3f>(_since)) {
+    update(mem, e);
+  }
+  for (Entity const& e : mem.changed<AABox3f>(_since)) {
+    update(mem, e);
+  }
+  _since = mem.tick();
+}
+
+void SpatialIndex::update(Memory const& mem, Entity const& entity) {
+  Tf3f const* tf = mem.get<Tf3f>(entity);
+  AABox3f const* box = mem.get<AABox3f>(entity);
+  if (tf && box) {
+    _tree.move(entity, box->move(*tf));
+  } else {
+    _tree.remove(entity);
+  }
+}
+
+}  // namespace arty
@@ -1,4 +1,5 @@
 #include <arty/core/system.hpp>
+#include <typeinfo>
 
 namespace arty {
 
@@ -18,6 +19,8 @@ Result System::init(Ptr<Memory> const& board,
 
 void System::release() {}
 
+std::string System::name() const { return demangle(typeid(*this).name()); }
+
 Result EventSystem::process(const Ptr<Memory>& board,
                             const Ptr<InputManager>& inputs) {
   if (inputs->pop(_event)) {
@@ -29,7 +32,7 @@ Result EventSystem::process(const Ptr<Memory>& board,
 Result EventSystem::init(const Ptr<Memory>& /*board*/,
                          const Ptr<InputManager>& inputs) {
   if (!inputs->attach(_input, _event)) {
-    return error("input already taken: " + std::to_string(_input.key()));
+    return error_as(ErrorCode::INVALID, "input already taken");
   }
   return ok();
 }
@@ -0,0 +1,140 @@
+#include <arty/core/thread_pool.hpp>
+
+namespace arty {
+
+namespace {
+// queue of the current thread, 0 outside of any pool
+thread_local ThreadPool const* current_pool = nullptr;
+thread_local std::size_t current_queue = 0;
+}  // namespace
+
+ThreadPool::ThreadPool(std::size_t size) {
+  std::size_t workers = size > 1 ? size - 1 : 0;
+  for (std::size_t i = 0; i <= workers; ++i) {
+    _queues.emplace_back(new Queue);
+  }
+  for (std::size_t i = 1; i <= workers; ++i) {
+    _workers.emplace_back([this, i] { work(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  wait();
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _wake.notify_all();
+  for (auto& worker : _workers) {
+    worker.join();
+  }
+}
+
+void ThreadPool::submit(task_type task) {
+  std::size_t index = current_pool == this
+                          ? current_queue
+                          : _next.fetch_add(1) % _queues.size();
+  _pending.fetch_add(1);
+  {
+    std::lock_guard<std::mutex> lock(_queues[index]->mutex);
+    // counted before a worker can pop it and decrement
+    _queued.fetch_add(1);
+    _queues[index]->tasks.push_back(std::move(task));
+  }
+  {
+    // a waiter checks _queued under the mutex, it cannot miss the wake up
+    std::lock_guard<std::mutex> lock(_mutex);
+  }
+  _wake.notify_one();
+}
+
+void ThreadPool::wait() {
+  task_type task;
+  while (_pending.load() > 0) {
+    if (pop(0, task)) {
+      run(task);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(_mutex);
+    _done.wait(lock,
+               [this] { return _pending.load() == 0 || _queued.load() > 0; });
+  }
+}
+
+void ThreadPool::parallelFor(std::size_t count,
+                             std::function<void(std::size_t)> const& body) {
+  std::atomic<std::size_t> remaining{count};
+  for (std::size_t i = 0; i < count; ++i) {
+    submit([this, &body, &remaining, i] {
+      body(i);
+      if (remaining.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _done.notify_all();
+      }
+    });
+  }
+  std::size_t self = current_pool == this ? current_queue : 0;
+  task_type task;
+  while (remaining.load() > 0) {
+    if (pop(self, task)) {
+      run(task);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(_mutex);
+    _done.wait(lock, [this, &remaining] {
+      return remaining.load() == 0 || _queued.load() > 0;
+    });
+  }
+}
+
+void ThreadPool::work(std::size_t self) {
+  current_pool = this;
+  current_queue = self;
+  task_type task;
+  while (true) {
+    if (pop(self, task)) {
+      run(task);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(_mutex);
+    _wake.wait(lock, [this] { return _stop || _queued.load() > 0; });
+    if (_stop) {
+      return;
+    }
+  }
+}
+
+bool ThreadPool::pop(std::size_t self, task_type& task) {
+  {
+    Queue& own = *_queues[self];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      _queued.fetch_sub(1);
+      return true;
+    }
+  }
+  for (std::size_t i = 1; i < _queues.size(); ++i) {
+    Queue& other = *_queues[(self + i) % _queues.size()];
+    std::lock_guard<std::mutex> lock(other.mutex);
+    if (!other.tasks.empty()) {
+      task = std::move(other.tasks.front());
+      other.tasks.pop_front();
+      _queued.fetch_sub(1);
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::run(task_type& task) {
+  task();
+  task = nullptr;
+  if (_pending.fetch_sub(1) == 1) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _done.notify_all();
+  }
+}
+
+}  // namespace arty
@@ -37,7 +37,7 @@ static void mouseCallback(GLFWwindow* /*window*/, int button, int action,
 Result GlfwWindow::init() {
   // Initialise GLFW
   if (!glfwInit()) {
-    return Result("Failed to initialize GLFW\n");
+    return error("Failed to initialize GLFW");
   }
 
   glfwWindowHint(GLFW_SAMPLES, 4);
@@ -65,9 +65,9 @@ Result GlfwWindow::init() {
 
   if (_window == NULL) {
     glfwTerminate();
-    return Result(
+    return error(
         "Failed to open GLFW window. If you have an Intel GPU, they are "
-        "not 3.3 compatible. Try the 2.1 version of the tutorials.\n");
+        "not 3.3 compatible. Try the 2.1 version of the tutorials.");
   }
   glfwMakeContextCurrent(_window);
 
@@ -75,7 +75,7 @@ Result GlfwWindow::init() {
   glewExperimental = GL_TRUE;
   if (glewInit() != GLEW_OK) {
     glfwTerminate();
-    return Result("Failed to initialize GLEW\n");
+    return error("Failed to initialize GLEW");
   }
 
   // Ensure we can capture the escape key being pressed below
@@ -13,8 +13,7 @@ Result GlRenderer2D::initText2D(const char* texturePath) {
   // Initialize text'ure
   _text2DTextureID = loadDDS(texturePath);
   if (_text2DTextureID == 0) {
-    return error(std::string("failed to load texture ") +
-                 std::string(texturePath));
+    return error_as(ErrorCode::IO, "failed to load texture");
   }
 
   // Initialize VBO
@@ -25,8 +24,7 @@ Result GlRenderer2D::initText2D(const char* texturePath) {
   _text2DShaderID = LoadShaders("../shaders/TextVertexShader.vertexshader",
                                 "../shaders/TextVertexShader.fragmentshader");
   if (_text2DShaderID == 0) {
-    return error(std::string("failed to load shader ") +
-                 std::string(texturePath));
+    return error_as(ErrorCode::IO, "failed to load shader");
   }
   // Initialize uniforms' IDs
   _text2DUniformID = glGetUniformLocation(_text2DShaderID, "myTextureSampler");
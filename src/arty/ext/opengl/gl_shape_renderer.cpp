@@ -3,6 +3,7 @@
 #include <arty/core/number.hpp>
 #include <arty/ext/opengl/gl_loader.hpp>
 #include <arty/ext/opengl/gl_shape_renderer.hpp>
+#include <algorithm>
 
 namespace arty {
 Result GlShapeRenderer::init() {
@@ -23,17 +24,21 @@ void GlShapeRenderer::draw(Entity const& e, const std::vector<Vec3f>& s,
                            const Mat4x4f& model, const Mat4x4f& view,
                            const Mat4x4f& proj) {
   import(e, s);
-  glUseProgram(_program);
-  Mat4x4f mvp = proj * view * model;
-  glUniformMatrix4fv(_mvp, 1, GL_FALSE, mvp.transpose().ptr());
-  glEnableVertexAttribArray(0);
   glBindBuffer(GL_ARRAY_BUFFER, _vbos[e]);
   glBufferData(GL_ARRAY_BUFFER,
                static_cast<GLsizeiptr>(s.size() * sizeof(Vec3f)), nullptr,
                GL_STREAM_DRAW);
   glBufferSubData(GL_ARRAY_BUFFER, 0,
                   static_cast<GLsizeiptr>(s.size() * sizeof(Vec3f)), s.data());
+  drawBuffer(_vbos[e], static_cast<int>(s.size()), proj * view * model);
+}
 
+void GlShapeRenderer::drawBuffer(unsigned int vbo, int count,
+                                 const Mat4x4f& mvp) {
+  glUseProgram(_program);
+  glUniformMatrix4fv(_mvp, 1, GL_FALSE, mvp.transpose().ptr());
+  glEnableVertexAttribArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo);
   glVertexAttribPointer(0,         // attribute
                         3,         // size
                         GL_FLOAT,  // type
@@ -41,7 +46,53 @@ void GlShapeRenderer::draw(Entity const& e, const std::vector<Vec3f>& s,
                         0,         // stride
                         nullptr    // array buffer offset
   );
-  glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(s.size()));
+  glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(count));
+}
+
+bool GlShapeRenderer::drawCached(Entity const& e, Kind kind,
+                                 Params const& params, const Mat4x4f& mvp) {
+  auto it = _shapes.find(e);
+  if (it == _shapes.end()) {
+    return false;
+  }
+  Shape const& shape = it->second[kind];
+  if (shape.vbo == 0 || shape.params != params) {
+    return false;
+  }
+  drawBuffer(shape.vbo, shape.count, mvp);
+  return true;
+}
+
+void GlShapeRenderer::cache(Entity const& e, Kind kind, Params const& params,
+                            const std::vector<Vec3f>& s, const Mat4x4f& mvp) {
+  Shape& shape = _shapes[e][kind];
+  if (shape.vbo == 0) {
+    glGenBuffers(1, &shape.vbo);
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, shape.vbo);
+  glBufferData(GL_ARRAY_BUFFER,
+               static_cast<GLsizeiptr>(s.size() * sizeof(Vec3f)), s.data(),
+               GL_STATIC_DRAW);
+  shape.count = static_cast<int>(s.size());
+  shape.params = params;
+  drawBuffer(shape.vbo, shape.count, mvp);
+}
+
+void GlShapeRenderer::forget(const Entity& e) {
+  auto it = _shapes.find(e);
+  if (it != _shapes.end()) {
+    for (Shape const& shape : it->second) {
+      if (shape.vbo != 0) {
+        glDeleteBuffers(1, &shape.vbo);
+      }
+    }
+    _shapes.erase(it);
+  }
+  auto vbo = _vbos.find(e);
+  if (vbo != _vbos.end()) {
+    glDeleteBuffers(1, &vbo->second);
+    _vbos.erase(vbo);
+  }
 }
 
 static Vec3f flip(Vec3f const& l, Vec3f const& r) {
@@ -51,6 +102,13 @@ static Vec3f flip(Vec3f const& l, Vec3f const& r) {
 void GlShapeRenderer::draw(const Entity& e, const AABox3f& box,
                            const Mat4x4f& model, const Mat4x4f& view,
                            const Mat4x4f& proj) {
+  Mat4x4f mvp = proj * view * model;
+  Params params{};
+  std::copy_n(box.center().ptr(), 3, params.begin());
+  std::copy_n(box.halfLength().ptr(), 3, params.begin() + 3);
+  if (drawCached(e, AABOX, params, mvp)) {
+    return;
+  }
   std::vector<Vec3f> lines;
   // sup part
   Vec3f prev = box.center() + box.halfLength();
@@ -103,12 +161,20 @@ void GlShapeRenderer::draw(const Entity& e, const AABox3f& box,
   next = box.center() + flip(box.halfLength(), Vec3f(-1.f, -1.f, -1.f));
   lines.push_back(prev);
   lines.push_back(next);
-  draw(e, lines, model, view, proj);
+  cache(e, AABOX, params, lines, mvp);
 }
 
 void GlShapeRenderer::draw(const Entity& e, const OBB3f& b,
                            const Mat4x4f& model, const Mat4x4f& view,
                            const Mat4x4f& proj) {
+  Mat4x4f mvp = proj * view * model;
+  Params params{};
+  std::copy_n(b.center().translation().ptr(), 3, params.begin());
+  std::copy_n(b.center().rotation().ptr(), 9, params.begin() + 3);
+  std::copy_n(b.halfLength().ptr(), 3, params.begin() + 12);
+  if (drawCached(e, OBB, params, mvp)) {
+    return;
+  }
   std::vector<Vec3f> l;
   // sup part
   Vec3f prev = b.center() * b.halfLength();
@@ -161,12 +227,19 @@ void GlShapeRenderer::draw(const Entity& e, const OBB3f& b,
   next = b.center() * flip(b.halfLength(), Vec3f(-1.f, -1.f, -1.f));
   l.push_back(prev);
   l.push_back(next);
-  draw(e, l, model, view, proj);
+  cache(e, OBB, params, l, mvp);
 }
 
 void GlShapeRenderer::draw(const Entity& e, const Sphere3f& s,
                            const Mat4x4f& model, const Mat4x4f& view,
                            const Mat4x4f& proj) {
+  Mat4x4f mvp = proj * view * model;
+  Params params{};
+  std::copy_n(s.center().ptr(), 3, params.begin());
+  params[3] = s.sqrRadius();
+  if (drawCached(e, SPHERE, params, mvp)) {
+    return;
+  }
   std::vector<Vec3f> lines;
   static std::size_t num_segments = 50;
   float angle = PI / num_segments * 2.f;
@@ -190,7 +263,7 @@ void GlShapeRenderer::draw(const Entity& e, const Sphere3f& s,
     lines.push_back(s.center() + prev);
     lines.push_back(s.center() + first);
   }
-  draw(e, lines, model, view, proj);
+  cache(e, SPHERE, params, lines, mvp);
 }
 
 void GlShapeRenderer::release() {}
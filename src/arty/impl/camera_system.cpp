@@ -16,7 +16,9 @@ FixedCameraSystem::FixedCameraSystem(const Ptr<Window>& w)
       _fov(45.0f),
       _eye(0.f, -20.f, 20.f),
       _target(0.f, 0.f, 2.f),
-      _updir(0.f, 1.f, 0.f) {}
+      _updir(0.f, 1.f, 0.f) {
+  writes<Camera>();
+}
 
 Result FixedCameraSystem::process(const Ptr<Memory>& board) {
   float ratio = static_cast<float>(_window->width()) / _window->height();
@@ -1,5 +1,6 @@
 #include <arty/impl/debug_hid_system.hpp>
 #include <cmath>
+#include <cstdio>
 
 namespace arty {
 
@@ -15,6 +16,21 @@ Result DebugHidSystem::process(Ptr<Memory> const& /*board*/) {
   text.position = Text::position_t(10, 10);
   text.size = 20;
   _renderer->draw(text);
+  if (!_profiler) {
+    return ok();
+  }
+  // the five slowest systems over the last second
+  auto summary = _profiler->summary(60);
+  text.size = 14;
+  for (std::size_t i = 0; i < summary.size() && i < 5; ++i) {
+    auto const& sum = summary[i];
+    char line[160];
+    std::snprintf(line, sizeof(line), "%6.2f ms %6.2f max %7zu ent %s",
+                  sum.frameMs, sum.maxMs, sum.entities, sum.name.c_str());
+    text.content = line;
+    text.position.y() += 20;
+    _renderer->draw(text);
+  }
   return ok();
 }
 
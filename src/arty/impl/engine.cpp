@@ -1,7 +1,25 @@
+#include <algorithm>
+#include <arty/core/headless_window.hpp>
 #include <arty/impl/engine.hpp>
+#include <chrono>
+#include <cmath>
+#include <thread>
 
 namespace arty {
 
+namespace {
+
+// a failing system fails every frame, do not flood the output
+void report(std::vector<Result> const& results) {
+  for (auto const& res : results) {
+    if (!res) {
+      logError(res);
+    }
+  }
+}
+
+}  // namespace
+
 Engine& Engine::setWindow(const Ptr<Window>& ptr) {
   _window = ptr;
   return *this;
@@ -19,51 +37,261 @@ Engine& Engine::setMouse(const Ptr<Mouse>& ptr) {
 
 Engine& Engine::addSystem(const Ptr<System>& system) {
   _systems.push_back(system);
+  _scheduled = false;
+  return *this;
+}
+
+Engine& Engine::addPlugin(std::string const& path) {
+  _plugins.emplace_back(_systems.size(), Plugin(path));
+  // loaded by start
+  _systems.push_back(nullptr);
+  _scheduled = false;
   return *this;
 }
 
 Engine& Engine::setBoard(const Ptr<Memory>& board) {
   _state = board;
+  _scheduled = false;
+  return *this;
+}
+
+Engine& Engine::setThreads(std::size_t threads) {
+  _pool = threads > 1 ? Ptr<ThreadPool>(new ThreadPool(threads)) : nullptr;
+  _fixed.setPool(_pool);
+  _scheduler.setPool(_pool);
+  // _render has none: rendering stays on the calling thread, and waiting on
+  // the pool would make it run simulation tasks
+  _scheduled = false;
+  return *this;
+}
+
+Engine& Engine::setStepRate(double hz) {
+  _stepRate = hz;
+  return *this;
+}
+
+Engine& Engine::setMaxSteps(std::size_t steps) {
+  _maxSteps = steps;
+  return *this;
+}
+
+Engine& Engine::setHeadless(double frameRate, bool realTime) {
+  _headless = true;
+  _frameRate = frameRate;
+  _realTime = realTime;
+  return *this;
+}
+
+Engine& Engine::setPipelined(bool pipelined) {
+  _pipelined = pipelined;
+  // one worker, the caller renders
+  _simulation = pipelined ? Ptr<ThreadPool>(new ThreadPool(2)) : nullptr;
+  _scheduled = false;
+  return *this;
+}
+
+Engine& Engine::setProfiler(Ptr<Profiler> const& profiler) {
+  _profiler = profiler;
+  _fixed.setProfiler(_profiler);
+  _scheduler.setProfiler(_profiler);
+  _render.setProfiler(_profiler);
+  _scheduled = false;
   return *this;
 }
 
 Result Engine::start() {
+  if (!_window && _headless) {
+    _window.reset(new HeadlessWindow);
+  }
   return_if_error(_window->init());
+  if (_profiler) {
+    _frameName = _profiler->add("frame");
+  }
+  for (auto& [index, plugin] : _plugins) {
+    return_if_error(plugin.load());
+    _systems[index] = plugin.system();
+  }
   for (auto const& system : _systems) {
-    return_if_error(system->init(_state, _inputs));
+    if (!_profiler) {
+      return_if_error(system->init(_state, _inputs));
+      continue;
+    }
+    auto sample =
+        _profiler->begin(_profiler->add(system->name()), ProfileSample::INIT);
+    Result res = system->init(_state, _inputs);
+    Access const& access = system->access();
+    _profiler->end(sample, _state->count(access.reads | access.writes));
+    return_if_error(res);
   }
   return ok();
 }
 
 Result Engine::step() {
-  Result res;
-  if (_window->width() == 0 || _window->height() == 0) {
+  if (!_headless && (_window->width() == 0 || _window->height() == 0)) {
     // window is not ready yet
     return ok();
   }
-  _window->clear();
-  for (auto system : _systems) {
-    if (system) {
-      res = system->process(_state, _inputs);
-      if (!res) {
-        std::cerr << res.message() << std::endl;
-      }
-    } else {
+  reload();
+  return_if_error(schedule());
+  ProfileSample sample;
+  if (_profiler) {
+    _profiler->nextFrame();
+    sample = _profiler->begin(_frameName, ProfileSample::FRAME);
+  }
+  Tick frame = _state->tick();
+  std::size_t steps;
+  if (_headless) {
+    steps = accumulate(1. / _frameRate);
+  } else {
+    double now = _window->getTime();
+    steps = accumulate(_lastTime < 0. ? 0. : now - _lastTime);
+    _lastTime = now;
+  }
+  if (_pipelined) {
+    // taken before the simulation starts using the devices
+    _inputs->copyTo(*_renderInputs);
+    _simulation->submit([this, steps] { simulate(steps); });
+  }
+  if (!_headless) {
+    _window->clear();
+  }
+  if (_pipelined) {
+    report(_render.run(_snapshot, _renderInputs));
+    _simulation->wait();
+  } else {
+    simulate(steps);
+  }
+  if (!_headless) {
+    _window->refresh();
+  }
+  _inputs->flush();
+  if (_pipelined) {
+    _state->copyTo(*_snapshot, _snapshotFamilies);
+  }
+  // every system ran since then, nobody needs those removals anymore
+  _state->forget(_lastFrame);
+  _lastFrame = frame;
+  if (_profiler) {
+    _profiler->end(sample);
+  }
+  return ok();
+}
+
+Result Engine::schedule() {
+  if (_scheduled) {
+    return ok();
+  }
+  for (auto const& system : _systems) {
+    if (!system) {
       return error("Null ptr system");
     }
   }
-  _window->refresh();
-  _inputs->flush();
+  std::vector<Ptr<System>> fixed, variable, render;
+  _snapshotFamilies.reset();
+  for (auto const& system : _systems) {
+    Access const& access = system->access();
+    if (access.fixedStep) {
+      fixed.push_back(system);
+    } else if (_pipelined && access.rendering) {
+      render.push_back(system);
+      _snapshotFamilies |= access.reads;
+    } else {
+      variable.push_back(system);
+    }
+  }
+  _fixed.build(fixed);
+  _scheduler.build(variable);
+  _render.build(render);
+  _state->setThreadPool(_pool);
+  if (_pipelined) {
+    if (!_snapshot) {
+      _snapshot.reset(new Memory);
+      _renderInputs.reset(new InputManager);
+    }
+    // the first frame draws the initial state
+    _state->copyTo(*_snapshot, _snapshotFamilies);
+  }
+  _scheduled = true;
   return ok();
 }
 
-Result Engine::run() {
+void Engine::reload() {
+  for (auto& [index, plugin] : _plugins) {
+    if (!plugin.changed()) {
+      continue;
+    }
+    Result res = plugin.load();
+    if (!res) {
+      logError(res, plugin.path() + ": " + plugin.reason());
+      continue;
+    }
+    res = plugin.system()->init(_state, _inputs);
+    if (!res) {
+      logError(res, plugin.path());
+      // the previous version keeps running, and is the one reloaded next
+      plugin.system()->release();
+      plugin.restore();
+      continue;
+    }
+    _systems[index]->release();
+    _systems[index] = plugin.system();
+    _scheduled = false;
+  }
+}
+
+void Engine::simulate(std::size_t steps) {
+  for (std::size_t i = 0; i < steps; ++i) {
+    SimulationClock* clock = _state->resource<SimulationClock>();
+    clock->stepIndex = i;
+    report(_fixed.run(_state, _inputs));
+    // a system may have cleared the memory
+    clock = _state->resource<SimulationClock>();
+    if (!clock) {
+      break;
+    }
+    clock->time += clock->step;
+  }
+  report(_scheduler.run(_state, _inputs));
+}
+
+std::size_t Engine::accumulate(double elapsed) {
+  SimulationClock* clock = _state->resource<SimulationClock>();
+  if (!clock) {
+    _state->write(SimulationClock());
+    clock = _state->resource<SimulationClock>();
+  }
+  clock->step = 1. / _stepRate;
+  _accumulator += elapsed;
+  // tolerate rounding, 1/60s is 30 steps of 1/1800s
+  auto steps = static_cast<std::size_t>(_accumulator / clock->step + 1e-9);
+  if (steps > _maxSteps) {
+    // the simulation cannot keep up, let it run slower than real time
+    steps = _maxSteps;
+    _accumulator = std::fmod(_accumulator, clock->step);
+  } else {
+    _accumulator = std::max(
+        0., _accumulator - static_cast<double>(steps) * clock->step);
+  }
+  clock->frameSteps = steps;
+  clock->stepIndex = 0;
+  clock->alpha = _accumulator / clock->step;
+  return steps;
+}
+
+Result Engine::run(std::size_t frames) {
   Result res;
   size_t count = 0;
   // For speed computation
   double lastTime = _window->getTime();
   int nbFrames = 0;
+  auto deadline = std::chrono::steady_clock::now();
+  auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(1. / _frameRate));
   do {
+    if (_headless && _realTime) {
+      std::this_thread::sleep_until(deadline);
+      deadline += period;
+    }
     // Measure speed
     double currentTime = _window->getTime();
     nbFrames++;
@@ -77,7 +305,8 @@ Result Engine::run() {
     }
     res = step();
     count++;
-  } while (res && _window->isOk() && _window->isVisible());
+  } while (res && _window->isOk() && _window->isVisible() &&
+           (frames == 0 || count < frames));
   return res;
 }
 
@@ -4,6 +4,12 @@ namespace arty {
 
 ButtonBuilder Button::builder() { return ButtonBuilder(); }
 
+GuiSystem::GuiSystem(Ptr<Window> window, Ptr<Renderer> renderer)
+    : _window(window), _renderer(renderer) {
+  reads<Button>();
+  renders();
+}
+
 Result GuiSystem::process(Ptr<Memory> const& board) {
   if (board->count<Button>()) {  // Text
     auto work = [=](Entity const& /*e*/, Button const& b) -> Result {
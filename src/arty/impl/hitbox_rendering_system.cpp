@@ -3,31 +3,43 @@
 
 namespace arty {
 Result HitBoxRenderingSystem::process(const Ptr<Memory>& board) {
-  Camera cam;
-  if (!board->read<Camera>(cam)) {
+  Camera const* cam = board->resource<Camera>();
+  if (!cam) {
     return error("no camera");
   }
+  // the renderer frees what it kept for the shapes removed since last frame
+  for (auto const& e : board->removed<AABox3f>(_lastRun)) {
+    _renderer->forget(e);
+  }
+  for (auto const& e : board->removed<OBB3f>(_lastRun)) {
+    _renderer->forget(e);
+  }
+  for (auto const& e : board->removed<Sphere3f>(_lastRun)) {
+    _renderer->forget(e);
+  }
+  _lastRun = board->tick();
+  Memory const& mem = *board;
+  _index.sync(mem);
 
   if (board->count<AABox3f>()) {  // AABB
-    auto work = [=](Entity const& e, Tf3f const& t,
-                    AABox3f const& b) -> Result {
-      _renderer->draw(e, b, t.toMat(), cam.view(), cam.projection());
-      return ok();
-    };
-    board->process<Tf3f, AABox3f>(work);
+    Frustum3f frustum(cam->projection() * cam->view());
+    _index.tree().query(frustum, [&](Entity const& e) {
+      Tf3f const* t = mem.get<Tf3f>(e);
+      AABox3f const* b = mem.get<AABox3f>(e);
+      if (t && b) {
+        _renderer->draw(e, *b, t->toMat(), cam->view(), cam->projection());
+      }
+    });
   }
   if (board->count<OBB3f>()) {  // OBB
-    auto work = [=](Entity const& e, Tf3f const& t, OBB3f const& b) -> Result {
-      _renderer->draw(e, b, t.toMat(), cam.view(), cam.projection());
-      return ok();
+    auto work = [=](Entity const& e, Tf3f const& t, OBB3f const& b) {
+      _renderer->draw(e, b, t.toMat(), cam->view(), cam->projection());
     };
     board->process<Tf3f, OBB3f>(work);
   }
   if (board->count<Sphere3f>()) {  // Sphere
-    auto work = [=](Entity const& e, Tf3f const& t,
-                    Sphere3f const& b) -> Result {
-      _renderer->draw(e, b, t.toMat(), cam.view(), cam.projection());
-      return ok();
+    auto work = [=](Entity const& e, Tf3f const& t, Sphere3f const& b) {
+      _renderer->draw(e, b, t.toMat(), cam->view(), cam->projection());
     };
     board->process<Tf3f, Sphere3f>(work);
   }
@@ -18,7 +18,7 @@ Result Loader::loadObj(const std::string &path, Mesh *out) {
   std::ifstream file;
   file.open(path);
   if (!file.is_open()) {
-    return error("error opening file: " + path);
+    return error_as(ErrorCode::IO, "error opening file");
   }
 
   std::string line;
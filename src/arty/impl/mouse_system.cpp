@@ -5,35 +5,37 @@ namespace arty {
 
 Result MouseSystem::process(const Ptr<Memory>& mem,
                             const Ptr<InputManager>& inputs) {
-  Camera camera;
-  if (!mem->read<Camera>(camera)) {
+  Camera const* camera = mem->resource<Camera>();
+  if (!camera) {
     return error("no camera");
   }
-  auto line = camera.raycast(Camera::pixel_type(inputs->position()));
+  auto line = camera->raycast(Camera::pixel_type(inputs->position()));
   Entity selected;
   auto closest = std::numeric_limits<float>::max();
   auto data = Vec3f();
 
-  if (mem->count<AABox3f>()) {
-    auto work = [&](Entity const& e, Tf3f const& t,
-                    AABox3f const& b) -> Result {
-      auto box = b.move(t);
-      auto intersection = Geo::intersect(line, box);
-      if (intersection.exist()) {
-        /* if closer to camera, select this one */
-        auto dist = (line.origin() - intersection.value()).normsqr();
-        if (dist < closest) {
-          selected = e;
-          closest = dist;
-          data = intersection.value();
-        }
+  Memory const& memory = *mem;
+  _index.sync(memory);
+  float scale = line.direction().normsqr();
+  _index.tree().raycast(line, [&](Entity const& e) {
+    Tf3f const* t = memory.get<Tf3f>(e);
+    AABox3f const* b = memory.get<AABox3f>(e);
+    if (!t || !b) {
+      return std::numeric_limits<float>::infinity();
+    }
+    auto intersection = Geo::intersect(line, b->move(*t));
+    if (intersection.exist()) {
+      /* if closer to camera, select this one */
+      auto dist = (line.origin() - intersection.value()).normsqr();
+      if (dist < closest) {
+        selected = e;
+        closest = dist;
+        data = intersection.value();
       }
-      return ok();
-    };
-    if (!mem->process<Tf3f, AABox3f>(work)) {
-      return error("failed to compute cursor 3d position");
     }
-  }
+    // farther boxes are not looked at anymore
+    return std::sqrt(closest / scale);
+  });
 
   Selected s;
   s.entity = selected;
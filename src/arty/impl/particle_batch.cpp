@@ -0,0 +1,210 @@
+#include <arty/impl/particle_batch.hpp>
+#include <array>
+#include <cassert>
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ARTY_X86
+#include <immintrin.h>
+#endif
+
+namespace arty {
+
+namespace {
+
+// what a kernel works on, the arrays of the batch by axis
+struct Arrays {
+  std::array<double*, 3> p;
+  std::array<double*, 3> v;
+  std::array<double const*, 3> g;
+  // spent by the step
+  std::array<double*, 3> f;
+  double const* factors;
+};
+
+// the operations of Physics::integrateMotion, in their order
+void scalar(Arrays const& a, std::size_t first, std::size_t last,
+            double dt) {
+  for (std::size_t axis = 0; axis < 3; ++axis) {
+    double* p = a.p[axis];
+    double* v = a.v[axis];
+    double const* g = a.g[axis];
+    double* f = a.f[axis];
+    for (std::size_t i = first; i < last; ++i) {
+      p[i] = p[i] + v[i] * dt;
+      v[i] = v[i] * a.factors[i] + (g[i] + f[i]) * dt;
+      f[i] = 0.;
+    }
+  }
+}
+
+#ifdef ARTY_X86
+
+// baseline of x86-64, no check needed there
+__attribute__((target("sse2"))) void sse2(Arrays const& a, std::size_t n,
+                                          double dt) {
+  __m128d const d = _mm_set1_pd(dt);
+  std::size_t const end = n - n % 2;
+  for (std::size_t axis = 0; axis < 3; ++axis) {
+    double* p = a.p[axis];
+    double* v = a.v[axis];
+    double const* g = a.g[axis];
+    double* f = a.f[axis];
+    for (std::size_t i = 0; i < end; i += 2) {
+      __m128d vi = _mm_loadu_pd(v + i);
+      __m128d pi = _mm_add_pd(_mm_loadu_pd(p + i), _mm_mul_pd(vi, d));
+      _mm_storeu_pd(p + i, pi);
+      __m128d acc = _mm_add_pd(_mm_loadu_pd(g + i), _mm_loadu_pd(f + i));
+      vi = _mm_add_pd(_mm_mul_pd(vi, _mm_loadu_pd(a.factors + i)),
+                      _mm_mul_pd(acc, d));
+      _mm_storeu_pd(v + i, vi);
+      _mm_storeu_pd(f + i, _mm_setzero_pd());
+    }
+  }
+  scalar(a, end, n, dt);
+}
+
+__attribute__((target("avx2"))) void avx2(Arrays const& a, std::size_t n,
+                                          double dt) {
+  __m256d const d = _mm256_set1_pd(dt);
+  std::size_t const end = n - n % 4;
+  for (std::size_t axis = 0; axis < 3; ++axis) {
+    double* p = a.p[axis];
+    double* v = a.v[axis];
+    double const* g = a.g[axis];
+    double* f = a.f[axis];
+    for (std::size_t i = 0; i < end; i += 4) {
+      __m256d vi = _mm256_loadu_pd(v + i);
+      __m256d pi = _mm256_add_pd(_mm256_loadu_pd(p + i), _mm256_mul_pd(vi, d));
+      _mm256_storeu_pd(p + i, pi);
+      __m256d acc =
+          _mm256_add_pd(_mm256_loadu_pd(g + i), _mm256_loadu_pd(f + i));
+      vi = _mm256_add_pd(_mm256_mul_pd(vi, _mm256_loadu_pd(a.factors + i)),
+                         _mm256_mul_pd(acc, d));
+      _mm256_storeu_pd(v + i, vi);
+      _mm256_storeu_pd(f + i, _mm256_setzero_pd());
+    }
+  }
+  scalar(a, end, n, dt);
+}
+
+// rounded once per multiply and add instead of twice
+__attribute__((target("avx2,fma"))) void avx2Fma(Arrays const& a,
+                                                 std::size_t n, double dt) {
+  __m256d const d = _mm256_set1_pd(dt);
+  std::size_t const end = n - n % 4;
+  for (std::size_t axis = 0; axis < 3; ++axis) {
+    double* p = a.p[axis];
+    double* v = a.v[axis];
+    double const* g = a.g[axis];
+    double* f = a.f[axis];
+    for (std::size_t i = 0; i < end; i += 4) {
+      __m256d vi = _mm256_loadu_pd(v + i);
+      _mm256_storeu_pd(p + i, _mm256_fmadd_pd(vi, d, _mm256_loadu_pd(p + i)));
+      __m256d acc =
+          _mm256_add_pd(_mm256_loadu_pd(g + i), _mm256_loadu_pd(f + i));
+      vi = _mm256_fmadd_pd(vi, _mm256_loadu_pd(a.factors + i),
+                           _mm256_mul_pd(acc, d));
+      _mm256_storeu_pd(v + i, vi);
+      _mm256_storeu_pd(f + i, _mm256_setzero_pd());
+    }
+  }
+  scalar(a, end, n, dt);
+}
+
+#endif
+
+}  // namespace
+
+ParticleBatch::Isa ParticleBatch::best(bool deterministic) {
+#ifdef ARTY_X86
+  static bool const avx2 = __builtin_cpu_supports("avx2");
+  static bool const fma = __builtin_cpu_supports("fma");
+  if (avx2) {
+    return fma && !deterministic ? Isa::AVX2_FMA : Isa::AVX2;
+  }
+#if defined(__x86_64__)
+  return Isa::SSE2;
+#else
+  static bool const sse2 = __builtin_cpu_supports("sse2");
+  return sse2 ? Isa::SSE2 : Isa::SCALAR;
+#endif
+#else
+  (void)deterministic;
+  return Isa::SCALAR;
+#endif
+}
+
+void ParticleBatch::push(Particle const& p) {
+  _px.push_back(p.position.x());
+  _py.push_back(p.position.y());
+  _pz.push_back(p.position.z());
+  _vx.push_back(p.velocity.x());
+  _vy.push_back(p.velocity.y());
+  _vz.push_back(p.velocity.z());
+  _gx.push_back(p.gravity.x());
+  _gy.push_back(p.gravity.y());
+  _gz.push_back(p.gravity.z());
+  vector_t force = p.forceaccu * p.inverseMass();
+  _fx.push_back(force.x());
+  _fy.push_back(force.y());
+  _fz.push_back(force.z());
+  _damping.push_back(p.damping);
+}
+
+void ParticleBatch::integrate(double dt) {
+  assert(dt > 0.);
+  std::size_t n = size();
+  _factors.resize(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    // particles mostly share their damping
+    if (_damping[i] != _base || dt != _dt) {
+      _base = _damping[i];
+      _dt = dt;
+      _factor = std::pow(_base, _dt);
+    }
+    _factors[i] = _factor;
+  }
+  Arrays a{{_px.data(), _py.data(), _pz.data()},
+           {_vx.data(), _vy.data(), _vz.data()},
+           {_gx.data(), _gy.data(), _gz.data()},
+           {_fx.data(), _fy.data(), _fz.data()},
+           _factors.data()};
+  switch (_isa) {
+#ifdef ARTY_X86
+    case Isa::SSE2:
+      sse2(a, n, dt);
+      return;
+    case Isa::AVX2:
+      avx2(a, n, dt);
+      return;
+    case Isa::AVX2_FMA:
+      avx2Fma(a, n, dt);
+      return;
+#endif
+    default:
+      scalar(a, 0, n, dt);
+  }
+}
+
+void ParticleBatch::store(std::size_t i, Particle& p) const {
+  p.position = position(i);
+  p.velocity = velocity(i);
+  p.forceaccu = vector_t();
+}
+
+void ParticleBatch::clear() {
+  for (auto* v : {&_px, &_py, &_pz, &_vx, &_vy, &_vz, &_gx, &_gy, &_gz,
+                  &_fx, &_fy, &_fz, &_damping}) {
+    v->clear();
+  }
+}
+
+void ParticleBatch::reserve(std::size_t count) {
+  for (auto* v : {&_px, &_py, &_pz, &_vx, &_vy, &_vz, &_gx, &_gy, &_gz,
+                  &_fx, &_fy, &_fz, &_damping, &_factors}) {
+    v->reserve(count);
+  }
+}
+
+}  // namespace arty
@@ -140,6 +140,12 @@ number_t Physics::separatingVelocity(Collision const& c, const Particle& p1,
 }
 
 void Physics::integrateMotion(Particle& p, double duration) const {
+  using std::pow;
+  integrateMotion(p, duration, pow(p.damping, number_t(duration)));
+}
+
+void Physics::integrateMotion(Particle& p, double duration,
+                              number_t factor) const {
   assert(duration > 0.);
   if (p.isStatic()) {
     return;
@@ -147,9 +153,7 @@ void Physics::integrateMotion(Particle& p, double duration) const {
   number_t dt(duration);
   p.position += p.velocity * dt;
   auto acceleration = p.gravity + p.forceaccu * p.inverseMass();
-  using std::pow;
-  auto powd = pow(p.damping, dt);
-  p.velocity = p.velocity * powd + acceleration * dt;
+  p.velocity = p.velocity * factor + acceleration * dt;
   p.forceaccu = vector_t();
 }
 
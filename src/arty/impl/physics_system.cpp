@@ -1,54 +1,207 @@
 #include <arty/impl/camera_system.hpp>
 #include <arty/impl/physics_system.hpp>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <utility>
 
 namespace arty {
 
-static constexpr double SPF = 1. / 60. / 30.;
-
 Result PhysicsSystem::process(const Ptr<Memory>& mem) {
-  for (int i = 0; i < 30; ++i) {
-    return_if_error(detectCollision(mem));
-    return_if_error(resolveCollision(mem));
-    return_if_error(integrateMotion(mem));
+  SimulationClock const* clock = mem->resource<SimulationClock>();
+  _step = clock ? clock->step : SimulationClock().step;
+  return_if_error(detectCollision(mem));
+  return_if_error(resolveCollision(mem));
+  return_if_error(updateIslands(mem));
+  return_if_error(integrateMotion(mem));
+  if (!clock || clock->lastStep()) {
+    return_if_error(removeFallen(mem));
   }
+  // transforms of new particles are needed by the next detection
+  _commands.flush(*mem);
   return ok();
 }
 
-Result PhysicsSystem::integrateMotion(const Ptr<Memory>& mem) const {
-  auto work = [mem](Entity const& e, Particle const& p) -> Result {
-    Particle np = p;
-    Physics phy;
-    phy.integrateMotion(np, SPF);
-    if (np.position.z() < -5) {
-      mem->remove(e);
+void PhysicsSystem::setSleeping(double velocity, double time) {
+  _sleepVelocity = velocity;
+  _sleepTime = time;
+  if (_sleepVelocity <= 0.) {
+    for (std::uint32_t i = 0; i < _islands.size(); ++i) {
+      wakeIsland(i);
+    }
+  }
+}
+
+Result PhysicsSystem::integrateMotion(const Ptr<Memory>& mem) {
+  if (mem->count<Particle>() == 0) {
+    return error_as(ErrorCode::NOT_FOUND, "unknown component");
+  }
+  Memory& memory = *mem;
+  Physics phy;
+  // particles are independent, the transform is their own component
+  std::atomic<bool> missing{false};
+  // damping is mostly shared, its power is computed again when it changes
+  auto work = [this, &memory, &phy, &missing, dt = _step,
+               damping = std::numeric_limits<number_t>::quiet_NaN(),
+               factor = number_t(1)](Entity const& e, Particle& p) mutable {
+    if (p.isStatic()) {
+      // rewritten only when moved, so the boxes on it can sleep
+      Tf3f const* tf = std::as_const(memory).get<Tf3f>(e);
+      if (!tf) {
+        missing = true;
+      } else if (tf->translation() != p.transform().translation()) {
+        *memory.get<Tf3f>(e) = p.transform();
+      }
+      return;
+    }
+    if (asleep(e)) {
+      return;
+    }
+    memory.touch<Particle>(e);
+    if (p.damping != damping) {
+      damping = p.damping;
+      factor = std::pow(damping, dt);
+    }
+    phy.integrateMotion(p, dt, factor);
+    Tf3f* tf = memory.get<Tf3f>(e);
+    if (tf) {
+      *tf = p.transform();
     } else {
-      mem->write(e, np);
-      mem->write(e, Tf3f(static_cast<Vec3f>(np.position)));
+      missing = true;
+    }
+  };
+  // as Memory::parallelProcess, which would mark sleeping particles changed
+  View<Particle> all = memory.view<Particle>();
+  std::size_t const grain = 1024;
+  std::size_t size = all.size();
+  std::size_t chunks = (size + grain - 1) / grain;
+  auto chunk = [&all, &work, size](std::size_t c) {
+    // a cache of its own
+    auto copy = work;
+    all.each(c * grain, std::min(size, (c + 1) * grain), copy);
+  };
+  if (mem->threadPool() && chunks > 1) {
+    mem->threadPool()->parallelFor(chunks, chunk);
+  } else {
+    for (std::size_t c = 0; c < chunks; ++c) {
+      chunk(c);
+    }
+  }
+  if (missing) {
+    // new particles, adding a component is not allowed in parallel
+    for (auto [e, p] : mem->view<Particle>()) {
+      if (!std::as_const(memory).get<Tf3f>(e)) {
+        _commands.write(e, p.transform());
+      }
     }
+  }
+  return ok();
+}
+
+Result PhysicsSystem::updateIslands(const Ptr<Memory>& mem) {
+  if (_sleepVelocity <= 0. || mem->count<Particle>() == 0) {
     return ok();
+  }
+  _nodes.clear();
+  _parents.clear();
+  double const threshold = _sleepVelocity * _sleepVelocity;
+  mem->process<Particle>([this, threshold](Entity const& e,
+                                           Particle const& p) {
+    if (p.isStatic() || asleep(e)) {
+      return;
+    }
+    Body& b = body(e);
+    b.node = static_cast<std::uint32_t>(_nodes.size());
+    b.still = p.velocity.dot(p.velocity) < threshold ? b.still + _step : 0.;
+    _nodes.push_back(e);
+    _parents.push_back(b.node);
+  });
+  // bodies in contact are in the same island, static ones do not link them
+  auto node = [this](Entity const& e) {
+    return e.index() < _bodies.size() && _bodies[e.index()].entity == e
+               ? _bodies[e.index()].node
+               : npos;
   };
-  return mem->process<Particle>(work);
+  if (mem->count<CollisionArray>()) {
+    mem->process<CollisionArray>([&](Entity const&, CollisionArray const& b) {
+      for (auto const& c : b) {
+        std::uint32_t n1 = node(c.entities().first);
+        std::uint32_t n2 = node(c.entities().second);
+        if (n1 != npos && n2 != npos) {
+          _parents[root(n1)] = root(n2);
+        }
+      }
+    });
+  }
+  // an island is as still as its least still body
+  _still.assign(_nodes.size(), std::numeric_limits<double>::infinity());
+  for (std::uint32_t n = 0; n < _nodes.size(); ++n) {
+    _parents[n] = root(n);
+    _still[_parents[n]] =
+        std::min(_still[_parents[n]], _bodies[_nodes[n].index()].still);
+  }
+  _islandOf.assign(_nodes.size(), npos);
+  bool slept = false;
+  for (std::uint32_t n = 0; n < _nodes.size(); ++n) {
+    Entity const& e = _nodes[n];
+    Body& b = _bodies[e.index()];
+    b.node = npos;
+    std::uint32_t r = _parents[n];
+    if (_still[r] < _sleepTime) {
+      continue;
+    }
+    if (_islandOf[r] == npos) {
+      if (_freeIslands.empty()) {
+        _islandOf[r] = static_cast<std::uint32_t>(_islands.size());
+        _islands.emplace_back();
+      } else {
+        _islandOf[r] = _freeIslands.back();
+        _freeIslands.pop_back();
+      }
+    }
+    b.island = _islandOf[r];
+    _islands[b.island].bodies.push_back(e);
+    mem->get<Particle>(e)->velocity = vector_t();
+    slept = true;
+  }
+  if (slept) {
+    for (std::uint32_t r : _islandOf) {
+      if (r != npos) {
+        _islands[r].since = mem->tick();
+      }
+    }
+    // the writes that follow wake them up, even if made during this tick,
+    // exclusive as in detectCollision
+    mem->advance();
+  }
+  return ok();
+}
+
+Result PhysicsSystem::removeFallen(const Ptr<Memory>& mem) {
+  for (auto [e, p] : mem->view<Particle>()) {
+    if (p.position.z() < -5) {
+      _commands.remove(e);
+    }
+  }
+  return ok();
 }
 
 Result PhysicsSystem::resolveCollision(const Ptr<Memory>& mem) const {
-  auto work = [mem](Entity const& e, CollisionArray const& buffer) -> Result {
+  Memory& memory = *mem;
+  auto work = [&memory, dt = _step](Entity const& e,
+                                    CollisionArray const& buffer) {
     Physics solver;
     for (auto const& c : buffer) {
-      Particle p1, p2;
-      if (!mem->read(c.entities().first, p1)) {
-        return ok();
-      }
-      if (!mem->read(c.entities().second, p2)) {
-        return ok();
+      Particle* p1 = memory.get<Particle>(c.entities().first);
+      Particle* p2 = memory.get<Particle>(c.entities().second);
+      if (!p1 || !p2) {
+        return;
       }
       if (e == c.entities().second) {
         std::swap(p1, p2);
       }
-      solver.resolve(c, p1, p2, SPF);
-      mem->write(c.entities().first, p1);
-      mem->write(c.entities().second, p2);
+      solver.resolve(c, *p1, *p2, dt);
     }
-    return ok();
   };
   if (mem->count<CollisionArray>()) {
     return mem->process<CollisionArray>(work);
@@ -56,38 +209,112 @@ Result PhysicsSystem::resolveCollision(const Ptr<Memory>& mem) const {
   return ok();
 }
 
-Result PhysicsSystem::detectCollision(const Ptr<Memory>& mem) const {
+Result PhysicsSystem::detectCollision(const Ptr<Memory>& mem) {
   mem->remove<CollisionArray>();
-  auto first_loop = [mem](Entity const& e1, Tf3f const& t,
-                          AABox3f const& b) -> Result {
-    auto second_loop = [mem, e1, t, b](Entity const& e2, Tf3f const& t2,
-                                       AABox3f const& b2) -> Result {
-      if (e1 >= e2) {
-        return ok();
-      }
-      Physics _collision;
-      Collision col = _collision.detectCollision(t, b, t2, b2);
-      if (col.exist()) {
-        col.set(e1, e2);
-        CollisionArray cols1, cols2;
-        // no previous collision is fine
-        (void)mem->read<CollisionArray>(e1, cols1);
-        cols1.push_back(col);
-        mem->write(e1, cols1);
+  Memory& memory = *mem;
+  for (std::uint32_t i = 0; i < _islands.size(); ++i) {
+    Tick since = _islands[i].since;
+    for (Entity const& e : _islands[i].bodies) {
+      if (!std::as_const(memory).get<Particle>(e) ||
+          memory.changed<Particle>(e, since) ||
+          memory.changed<AABox3f>(e, since)) {
+        wakeIsland(i);
+        break;
       }
-      return ok();
-    };
-    return mem->process<Tf3f, AABox3f>(second_loop);
+    }
+  }
+  for (auto [e, tf, box] : memory.view<Tf3f, AABox3f>()) {
+    _broadphase->update(e, box.move(tf));
+  }
+  _broadphase->setThreadPool(mem->threadPool());
+  _broadphase->sweep();
+  // Two boxes that did not move since the previous detection are both
+  // static or asleep (awake particles are written every substep): there is
+  // nothing to resolve between them, the pair is skipped.
+  Tick since = _lastDetection;
+  auto moved = [&memory, since](Entity const& e) {
+    return memory.changed<Tf3f>(e, since) ||
+           memory.changed<AABox3f>(e, since);
   };
-  if (mem->count<Tf3f>()) {
-    return mem->process<Tf3f, AABox3f>(first_loop);
+  Physics physics;
+  // read only, or the static boxes would look moved to the next detection
+  Memory const& boxes = memory;
+  for (auto const& [e1, e2] : _broadphase->pairs()) {
+    if (!moved(e1) && !moved(e2)) {
+      continue;
+    }
+    Collision col = physics.detectCollision(
+        *boxes.get<Tf3f>(e1), *boxes.get<AABox3f>(e1), *boxes.get<Tf3f>(e2),
+        *boxes.get<AABox3f>(e2));
+    if (!col.exist()) {
+      continue;
+    }
+    col.set(e1, e2);
+    // one of them moved, it hit the other
+    wake(e1);
+    wake(e2);
+    CollisionArray* cols = memory.get<CollisionArray>(e1);
+    if (cols) {
+      cols->push_back(col);
+    } else {
+      memory.write(e1, CollisionArray{col});
+    }
   }
+  // what happens from now on is seen by the next detection. Advancing the
+  // tick is only safe because nothing else runs meanwhile: the system is
+  // exclusive, see removesEntities in the constructor
+  _lastDetection = mem->tick();
+  mem->advance();
   return ok();
 }
 
+PhysicsSystem::Body& PhysicsSystem::body(Entity const& entity) {
+  std::size_t index = entity.index();
+  if (index >= _bodies.size()) {
+    _bodies.resize(index + 1);
+  }
+  Body& b = _bodies[index];
+  if (b.entity != entity) {
+    b = Body();
+    b.entity = entity;
+  }
+  return b;
+}
+
+std::uint32_t PhysicsSystem::root(std::uint32_t node) {
+  while (_parents[node] != node) {
+    // path halving
+    _parents[node] = _parents[_parents[node]];
+    node = _parents[node];
+  }
+  return node;
+}
+
+void PhysicsSystem::wake(Entity const& entity) {
+  if (asleep(entity)) {
+    wakeIsland(_bodies[entity.index()].island);
+  }
+}
+
+void PhysicsSystem::wakeIsland(std::uint32_t island) {
+  Island& i = _islands[island];
+  if (i.bodies.empty()) {
+    return;
+  }
+  for (Entity const& e : i.bodies) {
+    Body& b = _bodies[e.index()];
+    if (b.entity == e) {
+      b.island = npos;
+      b.still = 0.;
+    }
+  }
+  i.bodies.clear();
+  _freeIslands.push_back(island);
+}
+
 Result CollisionRenderingSystem::process(const Ptr<Memory>& mem) {
-  Camera cam;
-  if (!mem->read<Camera>(cam)) {
+  Camera const* cam = mem->resource<Camera>();
+  if (!cam) {
     return error("no camera provided");
   }
 
@@ -98,8 +325,8 @@ Result CollisionRenderingSystem::process(const Ptr<Memory>& mem) {
       auto n = static_cast<Vec3f>(col.normal() * col.penetration());
       lines.push_back(c);
       lines.push_back(c + n);
-      _renderer->draw(e, lines, Mat4x4f::identity(), cam.view(),
-                      cam.projection());
+      _renderer->draw(e, lines, Mat4x4f::identity(), cam->view(),
+                      cam->projection());
     }
     return ok();
   };
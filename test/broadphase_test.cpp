@@ -0,0 +1,340 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <arty/core/aabb_tree.hpp>
+#include <arty/core/broadphase.hpp>
+#include <arty/core/hash_grid.hpp>
+#include <arty/core/spatial_index.hpp>
+#include <random>
+
+using namespace arty;
+
+/**
+ * @brief Boxes wandering around, some appear and disappear
+ */
+struct Scene {
+  std::mt19937 gen{7};
+  std::vector<Entity> entities;
+  std::vector<AABox3f> boxes;
+  Entity::generation_type generation = 1;
+
+  void add(Entity::index_type index) {
+    std::uniform_real_distribution<float> pos(-10.f, 10.f);
+    std::uniform_real_distribution<float> len(0.1f, 1.5f);
+    entities.emplace_back(index, ++generation);
+    boxes.emplace_back(Vec3f(pos(gen), pos(gen), pos(gen)),
+                       Vec3f(len(gen), len(gen), len(gen)));
+  }
+
+  void move() {
+    std::uniform_real_distribution<float> step(-0.3f, 0.3f);
+    for (auto& box : boxes) {
+      box = AABox3f(box.center() + Vec3f(step(gen), step(gen), step(gen)),
+                    box.halfLength());
+    }
+  }
+
+  std::vector<EntityPair> pairs() const {
+    std::vector<EntityPair> res;
+    for (std::size_t i = 0; i < boxes.size(); ++i) {
+      for (std::size_t j = i + 1; j < boxes.size(); ++j) {
+        if (boxes[i].intersection(boxes[j]).exist()) {
+          res.emplace_back(std::min(entities[i], entities[j]),
+                           std::max(entities[i], entities[j]));
+        }
+      }
+    }
+    std::sort(res.begin(), res.end());
+    return res;
+  }
+};
+
+std::vector<EntityPair> sorted(std::vector<EntityPair> pairs) {
+  std::sort(pairs.begin(), pairs.end());
+  return pairs;
+}
+
+TEST(SweepAndPrune, sameAsBruteForce) {
+  Scene scene;
+  for (Entity::index_type i = 1; i <= 300; ++i) {
+    scene.add(i);
+  }
+  SweepAndPrune sap;
+  for (int round = 0; round < 50; ++round) {
+    if (round % 10 == 5) {
+      // a few go away, their index is reused by a new entity
+      for (int n = 0; n < 5; ++n) {
+        Entity::index_type index = scene.entities.back().index();
+        scene.entities.pop_back();
+        scene.boxes.pop_back();
+        scene.add(index);
+        scene.add(static_cast<Entity::index_type>(1000 + round * 10 + n));
+      }
+    }
+    for (std::size_t i = 0; i < scene.boxes.size(); ++i) {
+      sap.update(scene.entities[i], scene.boxes[i]);
+    }
+    sap.sweep();
+    ASSERT_EQ(sap.size(), scene.boxes.size());
+    auto expected = scene.pairs();
+    ASSERT_FALSE(expected.empty());
+    ASSERT_EQ(sorted(sap.pairs()), expected) << "round " << round;
+    scene.move();
+  }
+  sap.sweep();
+  ASSERT_EQ(sap.size(), 0);
+  ASSERT_TRUE(sap.pairs().empty());
+}
+
+TEST(SweepAndPrune, touching) {
+  SweepAndPrune sap;
+  Entity a(1, 0), b(2, 0), c(3, 0);
+  sap.update(a, AABox3f(Vec3f(), Vec3f::all(1.f)));
+  sap.update(b, AABox3f(Vec3f(2.f, 0.f, 0.f), Vec3f::all(1.f)));
+  sap.update(c, AABox3f(Vec3f(0.f, 0.f, 3.f), Vec3f::all(1.f)));
+  sap.sweep();
+  ASSERT_EQ(sap.pairs(), std::vector<EntityPair>{EntityPair(a, b)});
+  // c comes down onto a, b leaves
+  sap.update(a, AABox3f(Vec3f(), Vec3f::all(1.f)));
+  sap.update(b, AABox3f(Vec3f(2.5f, 0.f, 0.f), Vec3f::all(1.f)));
+  sap.update(c, AABox3f(Vec3f(0.f, 0.f, 2.f), Vec3f::all(1.f)));
+  sap.sweep();
+  ASSERT_EQ(sap.pairs(), std::vector<EntityPair>{EntityPair(a, c)});
+}
+
+// pairs of a broadphase whose boxes really overlap
+std::vector<EntityPair> overlapping(Scene const& scene,
+                                    std::vector<EntityPair> const& pairs) {
+  std::vector<EntityPair> res;
+  for (auto const& pair : pairs) {
+    auto a = std::find(scene.entities.begin(), scene.entities.end(),
+                       pair.first) -
+             scene.entities.begin();
+    auto b = std::find(scene.entities.begin(), scene.entities.end(),
+                       pair.second) -
+             scene.entities.begin();
+    if (scene.boxes[a].intersection(scene.boxes[b]).exist()) {
+      res.push_back(pair);
+    }
+  }
+  std::sort(res.begin(), res.end());
+  return res;
+}
+
+TEST(AABBTree, sameAsBruteForce) {
+  Scene scene;
+  for (Entity::index_type i = 1; i <= 300; ++i) {
+    scene.add(i);
+  }
+  AABBTree tree;
+  for (int round = 0; round < 50; ++round) {
+    if (round % 10 == 5) {
+      for (int n = 0; n < 5; ++n) {
+        Entity::index_type index = scene.entities.back().index();
+        scene.entities.pop_back();
+        scene.boxes.pop_back();
+        scene.add(index);
+        scene.add(static_cast<Entity::index_type>(1000 + round * 10 + n));
+      }
+    }
+    for (std::size_t i = 0; i < scene.boxes.size(); ++i) {
+      tree.update(scene.entities[i], scene.boxes[i]);
+    }
+    tree.sweep();
+    ASSERT_TRUE(tree.valid());
+    ASSERT_EQ(tree.size(), scene.boxes.size());
+    auto pairs = sorted(tree.pairs());
+    ASSERT_EQ(std::unique(pairs.begin(), pairs.end()), pairs.end());
+    ASSERT_EQ(overlapping(scene, pairs), scene.pairs()) << "round " << round;
+    scene.move();
+  }
+  tree.sweep();
+  ASSERT_EQ(tree.size(), 0);
+  ASSERT_TRUE(tree.pairs().empty());
+}
+
+TEST(SpatialHashGrid, sameAsBruteForce) {
+  Scene scene;
+  for (Entity::index_type i = 1; i <= 300; ++i) {
+    scene.add(i);
+  }
+  // a floor over many cells, tested apart
+  scene.entities.emplace_back(999, 1);
+  scene.boxes.emplace_back(Vec3f(0.f, 0.f, -5.f), Vec3f(20.f, 20.f, 1.f));
+  SpatialHashGrid grid(2.f);
+  grid.setThreadPool(std::make_shared<ThreadPool>(3));
+  for (int round = 0; round < 50; ++round) {
+    if (round % 10 == 5) {
+      for (int n = 0; n < 5; ++n) {
+        Entity::index_type index = scene.entities.back().index();
+        scene.entities.pop_back();
+        scene.boxes.pop_back();
+        scene.add(index);
+        scene.add(static_cast<Entity::index_type>(1000 + round * 10 + n));
+      }
+    }
+    for (std::size_t i = 0; i < scene.boxes.size(); ++i) {
+      grid.update(scene.entities[i], scene.boxes[i]);
+    }
+    grid.sweep();
+    ASSERT_EQ(grid.size(), scene.boxes.size());
+    auto expected = scene.pairs();
+    ASSERT_FALSE(expected.empty());
+    ASSERT_EQ(sorted(grid.pairs()), expected) << "round " << round;
+    scene.move();
+  }
+  grid.sweep();
+  ASSERT_EQ(grid.size(), 0);
+  ASSERT_TRUE(grid.pairs().empty());
+}
+
+TEST(SpatialHashGrid, touching) {
+  SpatialHashGrid grid(1.f);
+  Entity a(1, 0), b(2, 0), c(3, 0);
+  // b touches a on the border of a cell
+  grid.update(a, AABox3f(Vec3f(), Vec3f::all(1.f)));
+  grid.update(b, AABox3f(Vec3f(2.f, 0.f, 0.f), Vec3f::all(1.f)));
+  grid.update(c, AABox3f(Vec3f(0.f, 0.f, 3.f), Vec3f::all(1.f)));
+  grid.sweep();
+  ASSERT_EQ(grid.pairs(), std::vector<EntityPair>{EntityPair(a, b)});
+  grid.update(a, AABox3f(Vec3f(), Vec3f::all(1.f)));
+  grid.update(b, AABox3f(Vec3f(2.5f, 0.f, 0.f), Vec3f::all(1.f)));
+  grid.update(c, AABox3f(Vec3f(0.f, 0.f, 2.f), Vec3f::all(1.f)));
+  grid.sweep();
+  ASSERT_EQ(grid.pairs(), std::vector<EntityPair>{EntityPair(a, c)});
+}
+
+TEST(AABBTree, queries) {
+  Scene scene;
+  for (Entity::index_type i = 1; i <= 300; ++i) {
+    scene.add(i);
+  }
+  AABBTree tree(0.f);
+  for (std::size_t i = 0; i < scene.boxes.size(); ++i) {
+    tree.move(scene.entities[i], scene.boxes[i]);
+  }
+  ASSERT_TRUE(tree.valid());
+  AABox3f region(Vec3f(2.f, -1.f, 0.f), Vec3f(3.f, 4.f, 2.f));
+  std::vector<Entity> found;
+  tree.query(region, [&](Entity const& e) { found.push_back(e); });
+  std::vector<Entity> expected;
+  for (std::size_t i = 0; i < scene.boxes.size(); ++i) {
+    if (scene.boxes[i].intersection(region).exist()) {
+      expected.push_back(scene.entities[i]);
+    }
+  }
+  std::sort(found.begin(), found.end());
+  std::sort(expected.begin(), expected.end());
+  ASSERT_FALSE(expected.empty());
+  ASSERT_EQ(found, expected);
+
+  // the nearest box along the ray, the closest hits being visited first
+  Line3f ray(Vec3f(-20.f, -18.f, -19.f), Vec3f(-19.f, -17.1f, -18.f));
+  float const inf = std::numeric_limits<float>::infinity();
+  auto enter = [&ray, inf](AABox3f const& box) {
+    float lo = 0.f;
+    float hi = inf;
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      float d = ray.direction()[axis];
+      float o = ray.origin()[axis];
+      if (d == 0.f) {
+        if (o < box.min()[axis] || box.max()[axis] < o) {
+          return inf;
+        }
+        continue;
+      }
+      float t1 = (box.min()[axis] - o) / d;
+      float t2 = (box.max()[axis] - o) / d;
+      lo = std::max(lo, std::min(t1, t2));
+      hi = std::min(hi, std::max(t1, t2));
+    }
+    return lo <= hi ? lo : inf;
+  };
+  Entity nearest;
+  float best = inf;
+  std::size_t crossed = 0;
+  for (std::size_t i = 0; i < scene.boxes.size(); ++i) {
+    crossed += enter(scene.boxes[i]) < inf;
+    if (enter(scene.boxes[i]) < best) {
+      best = enter(scene.boxes[i]);
+      nearest = scene.entities[i];
+    }
+  }
+  ASSERT_GT(crossed, 1);
+  Entity hit;
+  float closest = inf;
+  std::size_t visited = 0;
+  tree.raycast(ray, [&](Entity const& e) {
+    ++visited;
+    auto i = std::find(scene.entities.begin(), scene.entities.end(), e) -
+             scene.entities.begin();
+    float t = enter(scene.boxes[i]);
+    if (t < closest) {
+      closest = t;
+      hit = e;
+    }
+    return closest;
+  });
+  ASSERT_EQ(hit, nearest);
+  ASSERT_LE(visited, crossed);
+
+  // the unit cube of clip space
+  std::vector<Entity> seen;
+  tree.query(Frustum3f(Mat4x4f::identity()),
+             [&](Entity const& e) { seen.push_back(e); });
+  expected.clear();
+  for (std::size_t i = 0; i < scene.boxes.size(); ++i) {
+    if (scene.boxes[i].intersection(AABox3f::unit()).exist()) {
+      expected.push_back(scene.entities[i]);
+    }
+  }
+  std::sort(seen.begin(), seen.end());
+  ASSERT_EQ(seen, expected);
+}
+
+TEST(AABBTree, balanced) {
+  // inserted in order, a tree without rotations would degenerate
+  AABBTree tree;
+  for (Entity::index_type i = 1; i <= 1024; ++i) {
+    tree.move(Entity(i, 0),
+              AABox3f(Vec3f(static_cast<float>(i), 0.f, 0.f),
+                      Vec3f::all(0.4f)));
+  }
+  ASSERT_TRUE(tree.valid());
+  ASSERT_LE(tree.height(), 30);
+  // moving inside the margin keeps the leaf
+  ASSERT_FALSE(tree.move(Entity(3, 0), AABox3f(Vec3f(3.05f, 0.f, 0.f),
+                                               Vec3f::all(0.4f))));
+  ASSERT_TRUE(tree.move(Entity(3, 0), AABox3f(Vec3f(500.f, 0.f, 0.f),
+                                              Vec3f::all(0.4f))));
+  ASSERT_TRUE(tree.remove(Entity(5, 0)));
+  ASSERT_FALSE(tree.contains(Entity(5, 0)));
+  ASSERT_FALSE(tree.remove(Entity(5, 0)));
+  ASSERT_EQ(tree.size(), 1023);
+  ASSERT_TRUE(tree.valid());
+}
+
+TEST(SpatialIndex, sync) {
+  Memory mem;
+  Entity a = mem.createEntity();
+  Entity b = mem.createEntity();
+  mem.write(a, Tf3f());
+  mem.write(a, AABox3f::unit());
+  mem.write(b, AABox3f::unit());
+  SpatialIndex index(0.f);
+  index.sync(mem);
+  ASSERT_TRUE(index.tree().contains(a));
+  ASSERT_FALSE(index.tree().contains(b));
+  mem.advance();
+  // b gets a transform, a moves then loses its box
+  mem.write(b, Tf3f(Vec3f(5.f, 0.f, 0.f)));
+  mem.write(a, Tf3f(Vec3f(0.f, 3.f, 0.f)));
+  index.sync(mem);
+  ASSERT_EQ(index.tree().fattened(b).center(), Vec3f(5.f, 0.f, 0.f));
+  ASSERT_EQ(index.tree().fattened(a).center(), Vec3f(0.f, 3.f, 0.f));
+  mem.advance();
+  mem.remove<AABox3f>(a);
+  index.sync(mem);
+  ASSERT_FALSE(index.tree().contains(a));
+  ASSERT_TRUE(index.tree().contains(b));
+}
@@ -71,3 +71,31 @@ TEST(Camera, position) {
   auto camera_pos = camera.transform().block<float, 3, 1>(0, 3);
   ASSERT_EQ(camera_pos, pt_t(10.f, 0.f, 0.f));
 }
+
+TEST(Camera, frustum) {
+  Camera camera;
+  camera.perspective(radians(45.f), 16.f / 9.f, 0.1f, 100.0f);
+  camera.lookAt(pt_t{10.f, 0.f, 0.f}, pt_t{0.f, 0.f, 0.f}, pt_t{0.f, 0.f, 1.f});
+  Frustum3f frustum(camera.projection() * camera.view());
+  ASSERT_TRUE(frustum.intersect(AABox3f(pt_t(), pt_t::all(1.f))));
+  // behind, beyond the far plane and aside
+  ASSERT_FALSE(
+      frustum.intersect(AABox3f(pt_t(20.f, 0.f, 0.f), pt_t::all(1.f))));
+  ASSERT_FALSE(
+      frustum.intersect(AABox3f(pt_t(-100.f, 0.f, 0.f), pt_t::all(1.f))));
+  ASSERT_FALSE(
+      frustum.intersect(AABox3f(pt_t(0.f, 20.f, 0.f), pt_t::all(1.f))));
+  // across the border of the view
+  ASSERT_TRUE(
+      frustum.intersect(AABox3f(pt_t(0.f, 7.5f, 0.f), pt_t::all(1.f))));
+}
+
+TEST(Camera, raycast) {
+  Camera camera;
+  camera.perspective(radians(45.f), 16.f / 9.f, 0.1f, 100.0f);
+  camera.lookAt(pt_t{10.f, 0.f, 0.f}, pt_t{0.f, 0.f, 0.f}, pt_t{0.f, 0.f, 1.f});
+  auto ray = camera.raycast(pix_t(0.f, 0.f));
+  ASSERT_EQ(ray.origin(), pt_t(10.f, 0.f, 0.f));
+  // towards the target
+  ASSERT_EQ(ray.direction(), pt_t(-1.f, 0.f, 0.f));
+}
@@ -0,0 +1,248 @@
+#include <gtest/gtest.h>
+
+#include <arty/impl/engine.hpp>
+#include <arty/impl/physics_system.hpp>
+
+using namespace arty;
+
+/**
+ * @brief Window whose time is set by the test
+ */
+class ManualWindow : public Window {
+ public:
+  ManualWindow() : Window(WindowMode::Windowed(1, 1), "manual") {}
+
+  Result init() override { return ok(); }
+  void clear() override { ++clears; }
+  void refresh() override { ++refreshes; }
+  bool isOk() const override { return true; }
+  void close() override {}
+  double getTime() override { return time; }
+  int width() const override { return 1; }
+  int height() const override { return 1; }
+  bool isVisible() const override { return true; }
+
+  double time = 0.;
+  int clears = 0;
+  int refreshes = 0;
+};
+
+class CountingSystem : public System {
+ public:
+  CountingSystem(bool fixed) {
+    if (fixed) {
+      fixedStep();
+    }
+  }
+
+  Result process(Ptr<Memory> const& mem) override {
+    ++calls;
+    clock = *mem->resource<SimulationClock>();
+    return ok();
+  }
+
+  int calls = 0;
+  SimulationClock clock;
+};
+
+TEST(Engine, fixedStep) {
+  Ptr<ManualWindow> window(new ManualWindow);
+  Ptr<CountingSystem> fixed(new CountingSystem(true));
+  Ptr<CountingSystem> frame(new CountingSystem(false));
+  Engine engine;
+  engine.setWindow(window)
+      .setBoard(Ptr<Memory>(new Memory))
+      .setStepRate(100.)
+      .setMaxSteps(10)
+      .addSystem(fixed)
+      .addSystem(frame);
+  ASSERT_TRUE(engine.start());
+
+  ASSERT_TRUE(engine.step());
+  ASSERT_EQ(fixed->calls, 0);
+  ASSERT_EQ(frame->calls, 1);
+
+  window->time = 0.035;
+  ASSERT_TRUE(engine.step());
+  ASSERT_EQ(fixed->calls, 3);
+  ASSERT_EQ(fixed->clock.stepIndex, 2);
+  ASSERT_EQ(frame->calls, 2);
+  ASSERT_EQ(frame->clock.frameSteps, 3);
+  ASSERT_NEAR(frame->clock.alpha, 0.5, 1e-6);
+  ASSERT_NEAR(frame->clock.time, 0.03, 1e-9);
+
+  // a one second hiccup only runs the maximum number of steps
+  window->time = 1.035;
+  ASSERT_TRUE(engine.step());
+  ASSERT_EQ(fixed->calls, 13);
+  ASSERT_LT(frame->clock.alpha, 1.);
+
+  window->time = 1.04;
+  ASSERT_TRUE(engine.step());
+  ASSERT_EQ(fixed->calls, 13 + static_cast<int>(frame->clock.frameSteps));
+  ASSERT_LE(frame->clock.frameSteps, 1);
+}
+
+TEST(Engine, headless) {
+  Ptr<ManualWindow> window(new ManualWindow);
+  Ptr<CountingSystem> fixed(new CountingSystem(true));
+  Ptr<CountingSystem> frame(new CountingSystem(false));
+  Engine engine;
+  engine.setWindow(window)
+      .setBoard(Ptr<Memory>(new Memory))
+      .setHeadless(60.)
+      .addSystem(fixed)
+      .addSystem(frame);
+  ASSERT_TRUE(engine.start());
+  // the window time is ignored, every frame is 1/60s
+  ASSERT_TRUE(engine.run(10));
+  ASSERT_EQ(frame->calls, 10);
+  ASSERT_EQ(fixed->calls, 300);
+  ASSERT_EQ(frame->clock.frameSteps, 30);
+  ASSERT_NEAR(frame->clock.time, 10. / 60., 1e-9);
+  ASSERT_EQ(window->clears, 0);
+  ASSERT_EQ(window->refreshes, 0);
+}
+
+TEST(Engine, headlessPhysics) {
+  Ptr<Memory> mem(new Memory);
+  auto floor = mem->createEntity("floor");
+  mem->write(floor, AABox3f(Vec3f::zero(), Vec3f::all(1.f)));
+  Particle fixed;
+  fixed.setMass(0);
+  mem->write(floor, fixed);
+  auto cube = mem->createEntity("cube");
+  mem->write(cube, AABox3f(Vec3f::zero(), Vec3f::all(1.f)));
+  Particle falling;
+  falling.position = vector_t(0, 0, 4);
+  mem->write(cube, falling);
+  Engine engine;
+  engine.setBoard(mem).setHeadless().addSystem(
+      Ptr<System>(new PhysicsSystem));
+  ASSERT_TRUE(engine.start());
+  // 2 seconds of simulation, without any window
+  ASSERT_TRUE(engine.run(120));
+  Tf3f tf;
+  ASSERT_TRUE(mem->read(cube, tf));
+  ASSERT_GT(tf.translation().z(), 1.5f);
+  ASSERT_LT(tf.translation().z(), 2.5f);
+  engine.stop();
+}
+
+struct Counter {
+  int value;
+};
+
+class IncrementSystem : public System {
+ public:
+  IncrementSystem() {
+    writes<Counter>();
+    anyThread();
+  }
+
+  Result process(Ptr<Memory> const& mem) override {
+    for (auto [e, c] : mem->view<Counter>()) {
+      (void)e;
+      ++c.value;
+    }
+    return ok();
+  }
+};
+
+class DrawSystem : public System {
+ public:
+  DrawSystem() {
+    reads<Counter>();
+    renders();
+  }
+
+  Result process(Ptr<Memory> const& mem) override {
+    board = mem.get();
+    for (auto [e, c] : mem->view<Counter>()) {
+      (void)e;
+      seen.push_back(c.value);
+    }
+    return ok();
+  }
+
+  Memory* board = nullptr;
+  std::vector<int> seen;
+};
+
+TEST(Engine, pipelined) {
+  Ptr<Memory> mem(new Memory);
+  Entity e = mem->createEntity();
+  mem->write(e, Counter{0});
+  Ptr<DrawSystem> draw(new DrawSystem);
+  Engine engine;
+  engine.setBoard(mem)
+      .setHeadless()
+      .setPipelined()
+      .addSystem(Ptr<System>(new IncrementSystem))
+      .addSystem(draw);
+  ASSERT_TRUE(engine.start());
+  ASSERT_TRUE(engine.run(5));
+  // drawn from a snapshot, one frame behind
+  ASSERT_NE(draw->board, mem.get());
+  ASSERT_EQ(draw->seen, (std::vector<int>{0, 1, 2, 3, 4}));
+  ASSERT_EQ(mem->get<Counter>(e)->value, 5);
+}
+
+class EmitSystem : public System {
+ public:
+  explicit EmitSystem(Event const& event) : _event(event) {
+    writes<Counter>();
+    anyThread();
+  }
+
+  Result process(Ptr<Memory> const&,
+                 Ptr<InputManager> const& inputs) override {
+    board = inputs.get();
+    inputs->emit(_event);
+    return ok();
+  }
+
+  InputManager* board = nullptr;
+
+ private:
+  Event _event;
+};
+
+class PopSystem : public System {
+ public:
+  explicit PopSystem(Event const& event) : _event(event) {
+    reads<Counter>();
+    renders();
+  }
+
+  Result process(Ptr<Memory> const&,
+                 Ptr<InputManager> const& inputs) override {
+    seen = inputs.get();
+    popped.push_back(inputs->pop(_event));
+    return ok();
+  }
+
+  InputManager* seen = nullptr;
+  std::vector<bool> popped;
+
+ private:
+  Event _event;
+};
+
+TEST(Engine, pipelinedInputs) {
+  Ptr<Memory> mem(new Memory);
+  Event shot("shot");
+  Ptr<EmitSystem> emit(new EmitSystem(shot));
+  Ptr<PopSystem> pop(new PopSystem(shot));
+  Engine engine;
+  engine.setBoard(mem)
+      .setHeadless()
+      .setPipelined()
+      .addSystem(emit)
+      .addSystem(pop);
+  ASSERT_TRUE(engine.start());
+  ASSERT_TRUE(engine.run(4));
+  // a copy of the events, taken before the simulation runs
+  ASSERT_NE(pop->seen, emit->board);
+  ASSERT_EQ(pop->popped, (std::vector<bool>{false, true, true, true}));
+}
@@ -1,7 +1,9 @@
 #include <gtest/gtest.h>
 
+#include <arty/core/command_buffer.hpp>
 #include <arty/core/math.hpp>
 #include <arty/core/memory.hpp>
+#include <thread>
 
 using namespace arty;
 
@@ -9,8 +11,9 @@ TEST(Memory, createEntity) {
   Memory board;
   auto e1 = board.createEntity("player");
   auto e2 = board.createEntity("player");
-  ASSERT_EQ(e1, Entity("player_1", 1));
+  ASSERT_EQ(e1, Entity(1, 0));
   ASSERT_NE(e1, e2);
+  ASSERT_EQ(board.name(e1), "player");
 }
 
 TEST(Memory, write) {
@@ -53,13 +56,13 @@ TEST(Memory, ClearProperties) {
 
 TEST(Memory, Iterate) {
   Memory board;
-  board.write(Entity("toto", 1), Vec3f());
-  board.write(Entity("toto", 10), Vec3f());
+  board.write(board.createEntity("toto"), Vec3f());
+  board.write(board.createEntity("toto"), Vec3f());
   std::size_t count = 0;
   ASSERT_TRUE(board.process<Vec3f>(
       [&count](Entity const& e, Vec3f const & /*p*/) -> Result {
         if (!e.isValid()) {
-          return error("invalid entity: " + e.name());
+          return error("invalid entity");
         }
         ++count;
         return ok();
@@ -80,15 +83,17 @@ TEST(Memory, Remove) {
 
 TEST(Memory, EasyTwoIterate) {
   Memory board;
-  board.write(Entity("toto", 1), Vec3f());
-  board.write(Entity("toto", 10), Vec3f());
-  board.write(Entity("toto", 1), 0.f);
-  board.write(Entity("toto", 10), 0.f);
+  Entity e1 = board.createEntity("toto");
+  Entity e2 = board.createEntity("toto");
+  board.write(e1, Vec3f());
+  board.write(e2, Vec3f());
+  board.write(e1, 0.f);
+  board.write(e2, 0.f);
   std::size_t count = 0;
   Result iterationResult = board.process<Vec3f, float>(
       [&count](Entity const& e, Vec3f const&, float) -> Result {
         if (!e.isValid()) {
-          return error("invalid entity: " + e.name());
+          return error("invalid entity");
         }
         ++count;
         return ok();
@@ -99,16 +104,19 @@ TEST(Memory, EasyTwoIterate) {
 
 TEST(Memory, TwoIterate) {
   Memory board;
-  board.write(Entity("toto", 1), Vec3f());
-  board.write(Entity("toto", 10), Vec3f());
-  board.write(Entity("toto", 1), 0.f);
-  board.write(Entity("toto", 10), 0.f);
-  board.write(Entity("toto", 5), 0.f);
+  Entity e1 = board.createEntity("toto");
+  Entity e2 = board.createEntity("toto");
+  Entity e3 = board.createEntity("toto");
+  board.write(e1, Vec3f());
+  board.write(e2, Vec3f());
+  board.write(e1, 0.f);
+  board.write(e2, 0.f);
+  board.write(e3, 0.f);
   std::size_t count = 0;
   Result iterationResult = board.process<Vec3f, float>(
       [&count](Entity const& e, Vec3f const&, float) -> Result {
         if (!e.isValid()) {
-          return error("invalid entity: " + e.name());
+          return error("invalid entity");
         }
         ++count;
         return ok();
@@ -124,3 +132,551 @@ TEST(Memory, ReadWriteV2) {
   ASSERT_TRUE(board.read(read));
   ASSERT_EQ(read, Vec3f(1.f, 2.f, 3.f));
 }
+
+TEST(Memory, RemoveKeepsOthers) {
+  Memory board;
+  Entity e1 = board.createEntity("toto");
+  Entity e2 = board.createEntity("toto");
+  Entity e3 = board.createEntity("toto");
+  board.write(e1, 1);
+  board.write(e2, 2);
+  board.write(e3, 3);
+  ASSERT_TRUE(board.remove<int>(e1));
+  ASSERT_EQ(board.count<int>(), 2);
+  int val = 0;
+  ASSERT_FALSE(board.read(e1, val));
+  ASSERT_TRUE(board.read(e2, val));
+  ASSERT_EQ(val, 2);
+  ASSERT_TRUE(board.read(e3, val));
+  ASSERT_EQ(val, 3);
+  board.write(e1, 4);
+  ASSERT_TRUE(board.read(e1, val));
+  ASSERT_EQ(val, 4);
+}
+
+TEST(Memory, WriteWhileIterating) {
+  Memory board;
+  Entity e1 = board.createEntity("toto");
+  Entity e2 = board.createEntity("toto");
+  board.write(e1, 1);
+  Entity added = board.createEntity("added");
+  std::size_t count = 0;
+  ASSERT_TRUE(board.process<int>([&](Entity const& e, int const&) -> Result {
+    ++count;
+    // in place update is visible right away
+    board.write(e, 2);
+    int val = 0;
+    board.read(e, val);
+    if (val != 2) {
+      return error("update not visible");
+    }
+    // insertion into the iterated family is postponed
+    board.write(added, 3);
+    if (board.read(added, val)) {
+      return error("insertion visible during iteration");
+    }
+    // other families are modified right away
+    board.write(e2, 1.f);
+    return ok();
+  }));
+  ASSERT_EQ(count, 1);
+  ASSERT_EQ(board.count<int>(), 2);
+  ASSERT_EQ(board.count<float>(), 1);
+  int val = 0;
+  ASSERT_TRUE(board.read(added, val));
+  ASSERT_EQ(val, 3);
+}
+
+TEST(Memory, RemoveWhileIterating) {
+  Memory board;
+  for (int i = 0; i < 10; ++i) {
+    board.write(board.createEntity("toto"), i);
+  }
+  std::size_t count = 0;
+  ASSERT_TRUE(board.process<int>([&](Entity const& e, int const&) -> Result {
+    ++count;
+    board.remove(e);
+    return ok();
+  }));
+  ASSERT_EQ(count, 10);
+  ASSERT_EQ(board.count<int>(), 0);
+}
+
+TEST(Memory, RemoveThenWriteWhileIterating) {
+  Memory board;
+  Entity e = board.createEntity("toto");
+  board.write(e, 1);
+  ASSERT_TRUE(board.process<int>([&](Entity const& it, int const&) -> Result {
+    board.remove<int>(it);
+    board.write(it, 2);
+    return ok();
+  }));
+  int val = 0;
+  ASSERT_TRUE(board.read(e, val));
+  ASSERT_EQ(val, 2);
+}
+
+TEST(Memory, SignatureWhileIterating) {
+  Memory board;
+  ComponentId id = ComponentRegistry::id<int>();
+  Entity e = board.createEntity("removed then written");
+  Entity f = board.createEntity("written then removed");
+  board.write(e, 1);
+  for (auto [it, val] : board.view<int>()) {
+    (void)it;
+    (void)val;
+    // the pool is iterated, both are applied once the loop is over
+    ASSERT_TRUE(board.remove<int>(e));
+    ASSERT_TRUE(board.write(e, 2));
+    ASSERT_TRUE(board.write(f, 3));
+    ASSERT_TRUE(board.remove<int>(f));
+  }
+  ASSERT_TRUE(board.signature(e).test(id));
+  ASSERT_FALSE(board.signature(f).test(id));
+  ASSERT_EQ(board.count<int>(), 1);
+  ASSERT_FALSE(board.remove<int>(f));
+  // the signature tells which families to leave
+  ASSERT_TRUE(board.remove(e));
+  ASSERT_EQ(board.count<int>(), 0);
+  std::size_t visits = 0;
+  for (auto [it, val] : board.view<int>()) {
+    (void)it;
+    (void)val;
+    ++visits;
+  }
+  ASSERT_EQ(visits, 0);
+}
+
+TEST(ComponentRegistry, id) {
+  ComponentId vec = ComponentRegistry::id<Vec3f>();
+  ComponentId f = ComponentRegistry::id<float>();
+  ASSERT_NE(vec, f);
+  ASSERT_EQ(vec, ComponentRegistry::id<Vec3f>());
+  ASSERT_EQ(vec, ComponentRegistry::id<Vec3f const>());
+  ASSERT_LT(vec, ComponentRegistry::size());
+  ASSERT_LT(f, ComponentRegistry::size());
+  ASSERT_EQ(ComponentRegistry::name<float>(), "float");
+}
+
+TEST(Memory, View) {
+  Memory board;
+  std::vector<Entity> entities;
+  for (int i = 0; i < 10; ++i) {
+    entities.push_back(board.createEntity("toto"));
+    board.write(entities.back(), i);
+  }
+  for (int i = 0; i < 10; i += 2) {
+    board.write(entities[i], Vec3f());
+  }
+  board.write(entities[3], 0.f);
+  board.write(entities[4], 0.f);
+  std::size_t count = 0;
+  for (auto [e, v, i] : board.view<Vec3f, int>()) {
+    ASSERT_TRUE(e.isValid());
+    ASSERT_EQ(i % 2, 0);
+    v = Vec3f::all(1.f);
+    ++count;
+  }
+  ASSERT_EQ(count, 5);
+  Vec3f v;
+  ASSERT_TRUE(board.read(entities[2], v));
+  ASSERT_EQ(v, Vec3f::all(1.f));
+  count = 0;
+  for (auto [e, v, i, f] : board.view<Vec3f, int, float>()) {
+    ASSERT_EQ(e, entities[4]);
+    ++count;
+  }
+  ASSERT_EQ(count, 1);
+  ASSERT_TRUE((board.view<Vec3f, double>().empty()));
+}
+
+TEST(Memory, Get) {
+  Memory board;
+  Entity e = board.createEntity("toto");
+  ASSERT_EQ(board.get<Vec3f>(e), nullptr);
+  board.write(e, Vec3f());
+  Vec3f* ptr = board.get<Vec3f>(e);
+  ASSERT_NE(ptr, nullptr);
+  *ptr = Vec3f(1.f, 2.f, 3.f);
+  Vec3f val;
+  ASSERT_TRUE(board.read(e, val));
+  ASSERT_EQ(val, Vec3f(1.f, 2.f, 3.f));
+}
+
+TEST(Memory, Update) {
+  Memory board;
+  Entity e1 = board.createEntity("toto");
+  Entity e2 = board.createEntity("toto");
+  board.write(e1, 1);
+  board.write(e2, 2);
+  ASSERT_TRUE(board.update<int>([](Entity const&, int& val) -> Result {
+    val *= 10;
+    return ok();
+  }));
+  ASSERT_EQ(*board.get<int>(e1), 10);
+  ASSERT_EQ(*board.get<int>(e2), 20);
+}
+
+TEST(Memory, ProcessReturnTypes) {
+  Memory board;
+  for (int i = 0; i < 10; ++i) {
+    Entity e = board.createEntity();
+    board.write(e, i);
+    board.write(e, 2.f * static_cast<float>(i));
+  }
+  int visited = 0;
+  ASSERT_TRUE(
+      board.process<int>([&](Entity const&, int const&) { ++visited; }));
+  ASSERT_EQ(visited, 10);
+
+  // false stops without error
+  visited = 0;
+  ASSERT_TRUE((board.process<int, float>(
+      [&](Entity const&, int const&, float const&) { return ++visited < 3; })));
+  ASSERT_EQ(visited, 3);
+
+  // an error stops and is returned
+  visited = 0;
+  Result res = board.process<int>([&](Entity const&, int const&) -> Result {
+    if (++visited == 5) {
+      return error("stop");
+    }
+    return ok();
+  });
+  ASSERT_FALSE(res);
+  ASSERT_STREQ(res.site()->message, "stop");
+  ASSERT_EQ(visited, 5);
+
+  // std::function still works
+  std::function<Result(Entity const&, int const&)> func =
+      [&](Entity const&, int const&) -> Result { return ok(); };
+  ASSERT_TRUE(board.process<int>(func));
+
+  // update marks what it visits as changed, process does not
+  Tick since = board.tick();
+  board.advance();
+  ASSERT_TRUE(board.process<int>([](Entity const&, int const&) {}));
+  ASSERT_TRUE(board.changed<int>(since).empty());
+  ASSERT_TRUE((board.update<int, float>(
+      [](Entity const&, int&, float& f) { f += 1.f; })));
+  ASSERT_EQ(board.changed<int>(since).size(), 10);
+  ASSERT_EQ(board.changed<float>(since).size(), 10);
+
+  ASSERT_FALSE(board.process<char>([](Entity const&, char const&) {}));
+}
+
+TEST(Memory, StaleEntity) {
+  Memory board;
+  Entity e1 = board.createEntity("toto");
+  board.write(e1, 1);
+  ASSERT_TRUE(board.isAlive(e1));
+  ASSERT_TRUE(board.remove(e1));
+  ASSERT_FALSE(board.isAlive(e1));
+  ASSERT_FALSE(board.remove(e1));
+  // the slot is recycled with a new generation
+  Entity e2 = board.createEntity();
+  ASSERT_EQ(e2.index(), e1.index());
+  ASSERT_NE(e2, e1);
+  ASSERT_TRUE(board.name(e2).empty());
+  ASSERT_FALSE(board.write(e1, 2));
+  ASSERT_TRUE(board.write(e2, 3));
+  int val = 0;
+  ASSERT_FALSE(board.read(e1, val));
+  ASSERT_TRUE(board.read(e2, val));
+  ASSERT_EQ(val, 3);
+}
+
+TEST(Memory, EntityChurn) {
+  Memory board;
+  for (int i = 0; i < 1000; ++i) {
+    Entity e = board.createEntity();
+    board.write(e, i);
+    board.remove(e);
+  }
+  ASSERT_EQ(board.createEntity().index(), 1);
+  ASSERT_EQ(board.count<int>(), 0);
+}
+
+TEST(Memory, Signature) {
+  Memory board;
+  Entity e = board.createEntity();
+  board.write(e, 1);
+  board.write(e, 2.0);
+  ASSERT_TRUE(board.signature(e).test(ComponentRegistry::id<int>()));
+  ASSERT_TRUE(board.signature(e).test(ComponentRegistry::id<double>()));
+  board.remove<int>(e);
+  ASSERT_FALSE(board.signature(e).test(ComponentRegistry::id<int>()));
+  board.remove<double>();
+  ASSERT_TRUE(board.signature(e).none());
+  board.write(e, 3);
+  board.remove(e);
+  ASSERT_TRUE(board.signature(e).none());
+}
+
+TEST(Memory, RemoveAll) {
+  Memory board;
+  std::vector<Entity> entities;
+  for (int i = 0; i < 100; ++i) {
+    entities.push_back(board.createEntity());
+    board.write(entities.back(), i);
+    if (i % 2 == 0) {
+      board.write(entities.back(), 0.5 * i);
+    }
+  }
+  // a large batch is compacted, a small one is removed one by one
+  std::vector<Entity> large(entities.begin(), entities.begin() + 50);
+  large.push_back(entities[0]);
+  ASSERT_EQ(board.removeAll(large), 50);
+  ASSERT_EQ(board.removeAll({entities[60], entities[61], entities[10]}), 2);
+  ASSERT_EQ(board.count<int>(), 48);
+  ASSERT_EQ(board.count<double>(), 24);
+  ASSERT_FALSE(board.isAlive(entities[0]));
+  ASSERT_FALSE(board.isAlive(entities[61]));
+  for (int i = 50; i < 100; ++i) {
+    bool removed = i == 60 || i == 61;
+    int val;
+    ASSERT_EQ(board.read(entities[i], val), !removed);
+    if (!removed) {
+      ASSERT_EQ(val, i);
+    }
+  }
+}
+
+TEST(Memory, RemoveAllWhileIterating) {
+  Memory board;
+  std::vector<Entity> entities;
+  for (int i = 0; i < 10; ++i) {
+    entities.push_back(board.createEntity());
+    board.write(entities.back(), i);
+  }
+  int visited = 0;
+  for (auto [e, val] : board.view<int>()) {
+    ASSERT_TRUE(e.isValid());
+    ASSERT_GE(val, 0);
+    if (visited == 0) {
+      ASSERT_EQ(board.removeAll(entities), 10);
+    }
+    ++visited;
+  }
+  ASSERT_EQ(visited, 10);
+  ASSERT_EQ(board.count<int>(), 0);
+}
+
+TEST(CommandBuffer, flush) {
+  Memory board;
+  Entity e1 = board.createEntity();
+  Entity e2 = board.createEntity();
+  Entity e3 = board.createEntity();
+  board.write(e1, 1);
+  board.write(e2, 2);
+  board.write(e3, 3);
+  CommandBuffer commands;
+  for (auto [e, val] : board.view<int>()) {
+    if (val == 1) {
+      commands.write(e, 1.5);
+      commands.remove<int>(e);
+    } else {
+      commands.remove(e);
+    }
+  }
+  ASSERT_EQ(commands.size(), 4);
+  ASSERT_EQ(board.count<int>(), 3);
+  commands.flush(board);
+  ASSERT_TRUE(commands.empty());
+  ASSERT_EQ(board.count<int>(), 0);
+  ASSERT_EQ(board.count<double>(), 1);
+  ASSERT_TRUE(board.isAlive(e1));
+  ASSERT_FALSE(board.isAlive(e2));
+  ASSERT_FALSE(board.isAlive(e3));
+}
+
+TEST(CommandBuffer, order) {
+  Memory board;
+  Entity e = board.createEntity();
+  CommandBuffer commands;
+  commands.write(e, 1);
+  commands.write(e, 2);
+  commands.remove(e);
+  commands.write(e, 3);
+  commands.flush(board);
+  ASSERT_FALSE(board.isAlive(e));
+  ASSERT_EQ(board.count<int>(), 0);
+}
+
+TEST(Memory, Resource) {
+  Memory board;
+  ASSERT_EQ(board.resource<Vec3f>(), nullptr);
+  board.write(Vec3f(1.f, 2.f, 3.f));
+  Vec3f* res = board.resource<Vec3f>();
+  ASSERT_NE(res, nullptr);
+  ASSERT_EQ(*res, Vec3f(1.f, 2.f, 3.f));
+  board.write(Vec3f(4.f, 5.f, 6.f));
+  ASSERT_EQ(board.resource<Vec3f>(), res);
+  ASSERT_EQ(*res, Vec3f(4.f, 5.f, 6.f));
+  // singletons are not components
+  Entity e = board.createEntity();
+  board.write(e, Vec3f(7.f, 8.f, 9.f));
+  ASSERT_EQ(board.count<Vec3f>(), 1);
+  int count = 0;
+  board.process<Vec3f>([&](Entity const& entity, Vec3f const&) -> Result {
+    EXPECT_EQ(entity, e);
+    ++count;
+    return ok();
+  });
+  ASSERT_EQ(count, 1);
+  ASSERT_TRUE(board.removeResource<Vec3f>());
+  ASSERT_EQ(board.resource<Vec3f>(), nullptr);
+  ASSERT_EQ(board.count<Vec3f>(), 1);
+  ASSERT_FALSE(board.write(Entity(), Vec3f()));
+}
+
+TEST(Memory, ChangeTicks) {
+  Memory board;
+  Entity e1 = board.createEntity();
+  Entity e2 = board.createEntity();
+  Entity e3 = board.createEntity();
+  board.write(e1, 1);
+  board.write(e2, 2);
+  board.write(e3, 3);
+  Tick last = board.tick();
+  board.advance();
+  ASSERT_TRUE(board.changed<int>(last).empty());
+  ASSERT_TRUE(board.added<int>(last).empty());
+
+  board.write(e1, 10);
+  *board.get<int>(e2) = 20;
+  board.remove<int>(e3);
+  Entity e4 = board.createEntity();
+  board.write(e4, 4);
+  ASSERT_TRUE(board.changed<int>(e1, last));
+  ASSERT_TRUE(board.changed<int>(e2, last));
+  ASSERT_FALSE(board.changed<int>(e3, last));
+  ASSERT_EQ(board.changed<int>(last).size(), 3);
+  ASSERT_EQ(board.added<int>(last), std::vector<Entity>{e4});
+  ASSERT_EQ(board.removed<int>(last), std::vector<Entity>{e3});
+
+  last = board.tick();
+  board.advance();
+  for (auto [e, val] : board.view<int>()) {
+    if (val == 4) {
+      val = 40;
+      board.touch<int>(e);
+    }
+  }
+  ASSERT_EQ(board.changed<int>(last), std::vector<Entity>{e4});
+  ASSERT_TRUE(board.removed<int>(last).empty());
+  board.forget(last);
+  ASSERT_TRUE(board.removed<int>(0).empty());
+}
+
+TEST(Memory, ParallelProcess) {
+  Memory board;
+  board.setThreadPool(Ptr<ThreadPool>(new ThreadPool(4)));
+  for (int i = 0; i < 10000; ++i) {
+    Entity e = board.createEntity();
+    board.write(e, i);
+    if (i % 3 == 0) {
+      board.write(e, 1.0);
+    }
+  }
+  Tick last = board.tick();
+  board.advance();
+  auto twice = [](Entity const&, int& val, double& d) -> Result {
+    val *= 2;
+    d = val;
+    return ok();
+  };
+  ASSERT_TRUE((board.parallelProcess<int, double>(twice, 100)));
+  for (auto [e, val, d] : board.view<int, double>()) {
+    ASSERT_TRUE(e.isValid());
+    ASSERT_EQ(val % 6, 0);
+    ASSERT_EQ(d, val);
+  }
+  ASSERT_EQ(board.changed<int>(last).size(), 3334);
+  auto fail = [](Entity const&, int& val) -> Result {
+    if (val == 42) {
+      return error("found");
+    }
+    return ok();
+  };
+  ASSERT_FALSE(board.parallelProcess<int>(fail, 64));
+  board.setThreadPool(nullptr);
+  ASSERT_FALSE(board.parallelProcess<int>(fail));
+}
+
+TEST(Memory, CreateWhileReading) {
+  Memory board;
+  std::vector<Entity> first;
+  for (int i = 0; i < 100; ++i) {
+    first.push_back(board.createEntity("first"));
+    board.write(first.back(), i);
+  }
+  // creation grows the entity table under the feet of the other system
+  std::thread creator([&board] {
+    for (int i = 0; i < 10000; ++i) {
+      board.write(board.createEntity("other"), i);
+    }
+  });
+  for (int round = 0; round < 100; ++round) {
+    for (auto const& e : first) {
+      ASSERT_TRUE(board.isAlive(e));
+      ASSERT_EQ(board.name(e), "first");
+      ASSERT_TRUE(board.write(e, 1.0));
+      ASSERT_TRUE(board.signature(e).test(ComponentRegistry::id<double>()));
+    }
+  }
+  creator.join();
+  ASSERT_EQ(board.count<int>(), 10100);
+  ASSERT_EQ(board.count<double>(), 100);
+}
+
+TEST(Memory, CopyTo) {
+  Memory board;
+  Entity e1 = board.createEntity();
+  Entity e2 = board.createEntity();
+  board.write(e1, 1);
+  board.write(e2, 2);
+  board.write(e1, 1.f);
+  board.write(Vec3f(1.f, 2.f, 3.f));
+  board.write(2.);
+  Tick last = board.tick();
+  board.advance();
+  board.write(e2, 20);
+
+  Signature families;
+  families.set(ComponentRegistry::id<int>());
+  families.set(ComponentRegistry::id<Vec3f>());
+  Memory snapshot;
+  board.copyTo(snapshot, families);
+  ASSERT_TRUE(snapshot.isAlive(e1));
+  ASSERT_TRUE(snapshot.isAlive(e2));
+  ASSERT_EQ(*snapshot.get<int>(e2), 20);
+  ASSERT_EQ(snapshot.count<int>(), 2);
+  ASSERT_EQ(snapshot.count<float>(), 0);
+  ASSERT_FALSE(snapshot.signature(e1).test(ComponentRegistry::id<float>()));
+  ASSERT_EQ(*snapshot.resource<Vec3f>(), Vec3f(1.f, 2.f, 3.f));
+  ASSERT_EQ(snapshot.resource<double>(), nullptr);
+  ASSERT_EQ(snapshot.tick(), board.tick());
+  ASSERT_EQ(snapshot.changed<int>(last), std::vector<Entity>{e2});
+
+  // the snapshot does not follow the board until the next copy
+  int const* value = snapshot.get<int>(e1);
+  Vec3f const* res = snapshot.resource<Vec3f>();
+  board.write(e1, 10);
+  board.write(Vec3f());
+  board.remove(e2);
+  ASSERT_EQ(*snapshot.get<int>(e1), 1);
+  ASSERT_TRUE(snapshot.isAlive(e2));
+  board.copyTo(snapshot, families);
+  ASSERT_FALSE(snapshot.isAlive(e2));
+  ASSERT_EQ(snapshot.count<int>(), 1);
+  // buffers are reused
+  ASSERT_EQ(snapshot.get<int>(e1), value);
+  ASSERT_EQ(*value, 10);
+  ASSERT_EQ(snapshot.resource<Vec3f>(), res);
+  ASSERT_EQ(*res, Vec3f());
+
+  // clear keeps the resource table usable
+  board.clear();
+  ASSERT_TRUE(board.write(Vec3f()));
+}
@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 
+#include <arty/impl/particle_batch.hpp>
 #include <arty/impl/physics.hpp>
+#include <arty/impl/physics_system.hpp>
+#include <random>
 
 using namespace arty;
 
@@ -97,3 +100,247 @@ TEST(Physics, resolveVelocity) {
     ASSERT_EQ(p2.velocity, vector_t());
   }
 }
+
+// varied enough for every operation to round
+static std::vector<Particle> randomParticles(std::size_t count) {
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<double> value(-10., 10.);
+  std::uniform_real_distribution<double> mass(0.1, 10.);
+  std::vector<Particle> particles;
+  for (std::size_t i = 0; i < count; ++i) {
+    Particle p;
+    p.position = vector_t(value(gen), value(gen), value(gen));
+    p.velocity = vector_t(value(gen), value(gen), value(gen));
+    p.forceaccu = vector_t(value(gen), value(gen), value(gen));
+    // runs of the same damping, as when it is shared
+    p.damping = i % 100 < 90 ? 0.9 : 0.5;
+    p.setMass(mass(gen));
+    particles.push_back(p);
+  }
+  return particles;
+}
+
+TEST(ParticleBatch, deterministic) {
+  // not a multiple of the width of the vectors
+  std::vector<Particle> expected = randomParticles(1003);
+  std::vector<ParticleBatch::Isa> isas{ParticleBatch::Isa::SCALAR};
+  if (ParticleBatch::best(true) != ParticleBatch::Isa::SCALAR) {
+    isas.push_back(ParticleBatch::Isa::SSE2);
+  }
+  if (ParticleBatch::best(true) == ParticleBatch::Isa::AVX2) {
+    isas.push_back(ParticleBatch::Isa::AVX2);
+  }
+  std::vector<std::vector<Particle>> results(
+      isas.size(), randomParticles(expected.size()));
+  Physics physics;
+  for (double dt : {1. / 1800., 1. / 1800., 1. / 60.}) {
+    for (auto& p : expected) {
+      physics.integrateMotion(p, dt);
+    }
+    for (std::size_t k = 0; k < isas.size(); ++k) {
+      ParticleBatch batch;
+      batch.setIsa(isas[k]);
+      for (auto const& p : results[k]) {
+        batch.push(p);
+      }
+      batch.integrate(dt);
+      for (std::size_t i = 0; i < results[k].size(); ++i) {
+        batch.store(i, results[k][i]);
+      }
+    }
+  }
+  for (std::size_t k = 0; k < isas.size(); ++k) {
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+      ASSERT_EQ(results[k][i].position, expected[i].position);
+      ASSERT_EQ(results[k][i].velocity, expected[i].velocity);
+      ASSERT_EQ(results[k][i].forceaccu, vector_t());
+    }
+  }
+}
+
+TEST(ParticleBatch, reused) {
+  std::vector<Particle> expected = randomParticles(1003);
+  std::vector<ParticleBatch::Isa> isas{ParticleBatch::Isa::SCALAR};
+  if (ParticleBatch::best(true) != ParticleBatch::Isa::SCALAR) {
+    isas.push_back(ParticleBatch::Isa::SSE2);
+  }
+  if (ParticleBatch::best(true) == ParticleBatch::Isa::AVX2) {
+    isas.push_back(ParticleBatch::Isa::AVX2);
+  }
+  std::vector<ParticleBatch> batches(isas.size());
+  for (std::size_t k = 0; k < isas.size(); ++k) {
+    batches[k].setIsa(isas[k]);
+    for (auto const& p : expected) {
+      batches[k].push(p);
+    }
+  }
+  Physics physics;
+  // the forces are pushed once, only the first step applies them
+  for (double dt : {1. / 1800., 1. / 1800., 1. / 60., 1. / 1800.}) {
+    for (auto& p : expected) {
+      physics.integrateMotion(p, dt);
+    }
+    for (auto& batch : batches) {
+      batch.integrate(dt);
+    }
+  }
+  for (auto const& batch : batches) {
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+      ASSERT_EQ(batch.position(i), expected[i].position);
+      ASSERT_EQ(batch.velocity(i), expected[i].velocity);
+    }
+  }
+}
+
+TEST(ParticleBatch, fused) {
+  std::vector<Particle> expected = randomParticles(1003);
+  ParticleBatch batch;
+  batch.setDeterministic(false);
+  for (auto const& p : expected) {
+    batch.push(p);
+  }
+  Physics physics;
+  for (auto& p : expected) {
+    physics.integrateMotion(p, 1. / 60.);
+  }
+  batch.integrate(1. / 60.);
+  for (std::size_t i = 0; i < expected.size(); ++i) {
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      ASSERT_NEAR(batch.position(i)[axis], expected[i].position[axis], 1e-12);
+      ASSERT_NEAR(batch.velocity(i)[axis], expected[i].velocity[axis], 1e-12);
+    }
+  }
+}
+
+static Entity makeCube(Memory& mem, vector_t const& pos, number_t mass) {
+  auto e = mem.createEntity("cube");
+  mem.write(e, AABox3f(Vec3f::zero(), Vec3f::all(1.f)));
+  Particle p;
+  p.position = pos;
+  p.setMass(mass);
+  mem.write(e, p);
+  return e;
+}
+
+TEST(PhysicsSystem, cubeRestsOnFloor) {
+  Ptr<Memory> mem(new Memory);
+  auto floor = makeCube(*mem, vector_t(), 0);
+  auto cube = makeCube(*mem, vector_t(0, 0, 4), 1);
+  PhysicsSystem physics;
+  // 2 seconds of simulation
+  for (int i = 0; i < 3600; ++i) {
+    ASSERT_TRUE(physics.process(mem));
+  }
+  Tf3f tf;
+  ASSERT_TRUE(mem->read(cube, tf));
+  ASSERT_GT(tf.translation().z(), 1.5f);
+  ASSERT_LT(tf.translation().z(), 2.5f);
+  ASSERT_TRUE(mem->read(floor, tf));
+  ASSERT_EQ(tf.translation(), Vec3f());
+}
+
+TEST(PhysicsSystem, fallingCubeIsRemoved) {
+  Ptr<Memory> mem(new Memory);
+  auto cube = makeCube(*mem, vector_t(0, 0, -4), 1);
+  PhysicsSystem physics;
+  for (int i = 0; i < 1800; ++i) {
+    physics.process(mem);
+  }
+  ASSERT_EQ(mem->get<Particle>(cube), nullptr);
+  ASSERT_EQ(mem->get<AABox3f>(cube), nullptr);
+  ASSERT_EQ(mem->count<Particle>(), 0);
+}
+
+TEST(PhysicsSystem, restingCubeSleeps) {
+  Ptr<Memory> mem(new Memory);
+  makeCube(*mem, vector_t(), 0);
+  auto cube = makeCube(*mem, vector_t(0, 0, 4), 1);
+  PhysicsSystem physics;
+  for (int i = 0; i < 3600; ++i) {
+    ASSERT_TRUE(physics.process(mem));
+  }
+  ASSERT_TRUE(physics.asleep(cube));
+  Tf3f before;
+  ASSERT_TRUE(mem->read(cube, before));
+  Tick since = mem->tick();
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_TRUE(physics.process(mem));
+  }
+  // neither simulated nor tested against the floor
+  ASSERT_FALSE(mem->changed<Particle>(cube, since));
+  ASSERT_FALSE(mem->changed<Tf3f>(cube, since));
+  ASSERT_EQ(mem->count<CollisionArray>(), 0);
+  Tf3f after;
+  ASSERT_TRUE(mem->read(cube, after));
+  ASSERT_EQ(after.translation(), before.translation());
+}
+
+TEST(PhysicsSystem, writeWakesUp) {
+  Ptr<Memory> mem(new Memory);
+  makeCube(*mem, vector_t(), 0);
+  auto cube = makeCube(*mem, vector_t(0, 0, 2), 1);
+  PhysicsSystem physics;
+  for (int i = 0; i < 1800; ++i) {
+    ASSERT_TRUE(physics.process(mem));
+  }
+  ASSERT_TRUE(physics.asleep(cube));
+  mem->get<Particle>(cube)->velocity = vector_t(0, 0, 5);
+  ASSERT_TRUE(physics.process(mem));
+  ASSERT_FALSE(physics.asleep(cube));
+  Tf3f tf;
+  ASSERT_TRUE(mem->read(cube, tf));
+  ASSERT_GT(tf.translation().z(), 2.f);
+}
+
+TEST(PhysicsSystem, contactWakesTheIsland) {
+  Ptr<Memory> mem(new Memory);
+  auto floor = makeCube(*mem, vector_t(), 0);
+  mem->write(floor, AABox3f(Vec3f::zero(), Vec3f(20.f, 20.f, 1.f)));
+  auto bottom = makeCube(*mem, vector_t(0, 0, 2), 1);
+  auto top = makeCube(*mem, vector_t(0, 0, 4), 1);
+  auto aside = makeCube(*mem, vector_t(5, 0, 2), 1);
+  PhysicsSystem physics;
+  for (int i = 0; i < 1800; ++i) {
+    ASSERT_TRUE(physics.process(mem));
+  }
+  ASSERT_TRUE(physics.asleep(bottom));
+  ASSERT_TRUE(physics.asleep(top));
+  ASSERT_TRUE(physics.asleep(aside));
+  // dropped on the stack, wakes both cubes but not the one aside
+  auto falling = makeCube(*mem, vector_t(0, 0, 7), 1);
+  bool woken = false;
+  for (int i = 0; i < 3600; ++i) {
+    ASSERT_TRUE(physics.process(mem));
+    woken = woken || !physics.asleep(bottom);
+    ASSERT_TRUE(physics.asleep(aside));
+  }
+  ASSERT_TRUE(woken);
+  ASSERT_TRUE(physics.asleep(bottom));
+  ASSERT_TRUE(physics.asleep(top));
+  ASSERT_TRUE(physics.asleep(falling));
+  Tf3f tf;
+  ASSERT_TRUE(mem->read(falling, tf));
+  ASSERT_GT(tf.translation().z(), 5.5f);
+  ASSERT_LT(tf.translation().z(), 6.5f);
+}
+
+TEST(PhysicsSystem, removalWakesTheIsland) {
+  Ptr<Memory> mem(new Memory);
+  makeCube(*mem, vector_t(), 0);
+  auto bottom = makeCube(*mem, vector_t(0, 0, 2), 1);
+  auto top = makeCube(*mem, vector_t(0, 0, 4), 1);
+  PhysicsSystem physics;
+  for (int i = 0; i < 1800; ++i) {
+    ASSERT_TRUE(physics.process(mem));
+  }
+  ASSERT_TRUE(physics.asleep(top));
+  mem->remove(bottom);
+  ASSERT_TRUE(physics.process(mem));
+  ASSERT_FALSE(physics.asleep(top));
+  for (int i = 0; i < 3600; ++i) {
+    ASSERT_TRUE(physics.process(mem));
+  }
+  Tf3f tf;
+  ASSERT_TRUE(mem->read(top, tf));
+  ASSERT_LT(tf.translation().z(), 2.5f);
+}
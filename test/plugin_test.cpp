@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <arty/impl/engine.hpp>
+#include <chrono>
+#include <fstream>
+
+#include "plugins/counter.hpp"
+
+using namespace arty;
+namespace fs = std::filesystem;
+
+/**
+ * @brief Stands for the build: replaces the plugin and bumps its time, the
+ * file system may not tell two writes in the same second apart
+ */
+void install(fs::path const& from, fs::path const& to) {
+  auto previous = fs::exists(to) ? fs::last_write_time(to)
+                                 : fs::file_time_type::clock::now();
+  fs::copy_file(from, to, fs::copy_options::overwrite_existing);
+  fs::last_write_time(to, previous + std::chrono::seconds(2));
+}
+
+Counter counter(Memory& mem) {
+  for (auto [e, c] : mem.view<Counter>()) {
+    (void)e;
+    return c;
+  }
+  return Counter{-1, -1};
+}
+
+TEST(Plugin, load) {
+  Plugin missing("does_not_exist.so");
+  ASSERT_EQ(missing.load().code(), ErrorCode::NOT_FOUND);
+  ASSERT_FALSE(missing.reason().empty());
+  ASSERT_FALSE(missing.system());
+
+  Plugin plugin(COUNTER_PLUGIN_1);
+  ASSERT_TRUE(plugin.load());
+  ASSERT_FALSE(plugin.changed());
+  ASSERT_TRUE(plugin.system());
+  ASSERT_EQ(plugin.system()->name(), "CounterSystem");
+  ASSERT_TRUE(plugin.system()->access().writes.test(
+      ComponentRegistry::id<Counter>()));
+  Ptr<System> first = plugin.system();
+  ASSERT_TRUE(plugin.load());
+  ASSERT_NE(plugin.system(), first);
+  plugin.restore();
+  ASSERT_EQ(plugin.system(), first);
+}
+
+TEST(Plugin, hotReload) {
+  fs::path path = fs::temp_directory_path() / "counter_plugin_test.so";
+  install(COUNTER_PLUGIN_1, path);
+  Ptr<Memory> mem(new Memory);
+  Engine engine;
+  engine.setBoard(mem).setHeadless().addPlugin(path.string());
+  ASSERT_TRUE(engine.start());
+  ASSERT_TRUE(engine.run(3));
+  ASSERT_EQ(counter(*mem).value, 3);
+  ASSERT_EQ(counter(*mem).inits, 1);
+  std::size_t types = ComponentRegistry::size();
+
+  // swapped at the next frame, the board is kept
+  install(COUNTER_PLUGIN_10, path);
+  ASSERT_TRUE(engine.run(2));
+  ASSERT_EQ(counter(*mem).value, 23);
+  ASSERT_EQ(counter(*mem).inits, 2);
+  ASSERT_EQ(mem->count<Counter>(), 1);
+  ASSERT_EQ(ComponentRegistry::size(), types);
+
+  // a broken build keeps the previous version running
+  {
+    std::ofstream broken(path, std::ios::trunc);
+    broken << "not a shared object";
+  }
+  fs::last_write_time(path,
+                      fs::last_write_time(path) + std::chrono::seconds(4));
+  testing::internal::CaptureStderr();
+  ASSERT_TRUE(engine.run(2));
+  std::string out = testing::internal::GetCapturedStderr();
+  // reported once, with the reason of the loader
+  auto at = out.find("cannot open plugin: " + path.string());
+  ASSERT_NE(at, std::string::npos);
+  ASSERT_EQ(out.find("cannot open plugin", at + 1), std::string::npos);
+  ASSERT_EQ(counter(*mem).value, 43);
+  ASSERT_EQ(counter(*mem).inits, 2);
+
+  // so does a version failing to init
+  mem->write(RefuseInit());
+  install(COUNTER_PLUGIN_1, path);
+  testing::internal::CaptureStderr();
+  ASSERT_TRUE(engine.run(2));
+  out = testing::internal::GetCapturedStderr();
+  ASSERT_NE(out.find("init refused"), std::string::npos);
+  ASSERT_EQ(counter(*mem).value, 63);
+  ASSERT_EQ(counter(*mem).inits, 2);
+
+  engine.stop();
+  fs::remove(path);
+}
@@ -0,0 +1,17 @@
+#ifndef COUNTER_HPP
+#define COUNTER_HPP
+
+/**
+ * @brief Component shared by plugin_test and its plugin
+ */
+struct Counter {
+  int value = 0;
+  int inits = 0;
+};
+
+/**
+ * @brief Resource making the init of the plugin fail
+ */
+struct RefuseInit {};
+
+#endif  // COUNTER_HPP
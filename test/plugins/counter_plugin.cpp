@@ -0,0 +1,42 @@
+#include <arty/core/plugin.hpp>
+
+#include "counter.hpp"
+
+using namespace arty;
+
+// unknown to the host, but the same family from one version to the next
+struct PluginOnly {
+  int version = STEP;
+};
+
+/**
+ * @brief Adds STEP to the counter every frame, built once per STEP
+ */
+class CounterSystem : public System {
+ public:
+  CounterSystem() { writes<Counter>(); }
+
+  Result init(Ptr<Memory> const& mem) override {
+    if (mem->resource<RefuseInit>()) {
+      return error("init refused");
+    }
+    if (mem->count<Counter>() == 0) {
+      mem->write(mem->createEntity("counter"), Counter());
+    }
+    for (auto [e, counter] : mem->view<Counter>()) {
+      ++counter.inits;
+      mem->write(e, PluginOnly());
+    }
+    return ok();
+  }
+
+  Result process(Ptr<Memory> const& mem) override {
+    for (auto [e, counter] : mem->view<Counter>()) {
+      (void)e;
+      counter.value += STEP;
+    }
+    return ok();
+  }
+};
+
+ARTY_PLUGIN(CounterSystem)
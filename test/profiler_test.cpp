@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include <arty/core/headless_window.hpp>
+#include <arty/core/profiler.hpp>
+#include <arty/impl/engine.hpp>
+#include <sstream>
+
+using namespace arty;
+
+struct Position {
+  float value;
+};
+
+class MoveSystem : public System {
+ public:
+  MoveSystem() {
+    writes<Position>();
+    anyThread();
+  }
+
+  Result init(Ptr<Memory> const& mem) override {
+    for (int i = 0; i < 10; ++i) {
+      mem->write(mem->createEntity(), Position{0.f});
+    }
+    return ok();
+  }
+
+  Result process(Ptr<Memory> const& mem) override {
+    for (auto [e, p] : mem->view<Position>()) {
+      (void)e;
+      p.value += 1.f;
+    }
+    return ok();
+  }
+};
+
+TEST(Profiler, ring) {
+  Profiler profiler(3);
+  std::uint32_t a = profiler.add("a");
+  ASSERT_EQ(profiler.add("b"), a + 1);
+  ASSERT_EQ(profiler.add("a"), a);
+  ASSERT_EQ(profiler.name(a), "a");
+  for (int i = 0; i < 6; ++i) {
+    ProfileSample sample;
+    sample.name = a;
+    sample.start = i;
+    profiler.record(sample);
+  }
+  // capacity is rounded up to 4, the oldest samples are gone
+  auto samples = profiler.samples();
+  ASSERT_EQ(samples.size(), 4);
+  for (std::size_t i = 0; i < samples.size(); ++i) {
+    ASSERT_EQ(samples[i].start, static_cast<std::int64_t>(i) + 2);
+  }
+}
+
+TEST(Profiler, engine) {
+  Ptr<Profiler> profiler(new Profiler);
+  Ptr<MoveSystem> move(new MoveSystem);
+  Engine engine;
+  engine.setWindow(Ptr<Window>(new HeadlessWindow))
+      .setBoard(Ptr<Memory>(new Memory))
+      .setHeadless()
+      .setProfiler(profiler)
+      .addSystem(move);
+  ASSERT_TRUE(engine.start());
+  ASSERT_TRUE(engine.run(5));
+  ASSERT_EQ(profiler->frame(), 5);
+
+  std::size_t inits = 0, processes = 0, frames = 0;
+  for (auto const& sample : profiler->samples()) {
+    ASSERT_GE(sample.duration, 0);
+    switch (sample.kind) {
+      case ProfileSample::INIT:
+        ++inits;
+        break;
+      case ProfileSample::PROCESS:
+        ++processes;
+        ASSERT_EQ(profiler->name(sample.name), move->name());
+        ASSERT_EQ(sample.entities, 10);
+        break;
+      case ProfileSample::FRAME:
+        ++frames;
+        break;
+    }
+  }
+  ASSERT_EQ(inits, 1);
+  ASSERT_EQ(processes, 5);
+  ASSERT_EQ(frames, 5);
+
+  auto summary = profiler->summary(2);
+  ASSERT_EQ(summary.size(), 1);
+  ASSERT_EQ(summary[0].name, "MoveSystem");
+  ASSERT_EQ(summary[0].calls, 2);
+  ASSERT_EQ(summary[0].entities, 10);
+  ASSERT_LE(summary[0].frameMs, summary[0].maxMs);
+
+  std::stringstream trace;
+  profiler->writeTrace(trace);
+  std::string json = trace.str();
+  ASSERT_EQ(json.rfind("{\"traceEvents\":[", 0), 0);
+  ASSERT_NE(json.find("\"name\":\"MoveSystem\",\"cat\":\"process\""),
+            std::string::npos);
+  ASSERT_NE(json.find("\"cat\":\"init\""), std::string::npos);
+  ASSERT_NE(json.find("\"cat\":\"frame\""), std::string::npos);
+}
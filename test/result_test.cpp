@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+
+#include <arty/core/result.hpp>
+
+using namespace arty;
+
+static Result fail() { return error_as(ErrorCode::NOT_FOUND, "not there"); }
+
+static Result forward(bool& reached) {
+  return_if_error(fail());
+  reached = true;
+  return ok();
+}
+
+TEST(Result, error) {
+  Result res = ok();
+  ASSERT_TRUE(res);
+  ASSERT_EQ(res.message(), "ok");
+  ASSERT_EQ(res.site(), nullptr);
+
+  res = fail();
+  ASSERT_FALSE(res);
+  ASSERT_EQ(res.code(), ErrorCode::NOT_FOUND);
+  ASSERT_NE(res.site(), nullptr);
+  ASSERT_STREQ(res.site()->message, "not there");
+  ASSERT_NE(res.message().find("result_test.cpp:"), std::string::npos);
+  ASSERT_NE(res.message().find(":not there"), std::string::npos);
+  // every call returns the same site
+  ASSERT_EQ(fail().site(), res.site());
+
+  ASSERT_FALSE(Result(false));
+  ASSERT_EQ(Result(false).message(), "unknown error");
+  ASSERT_THROW(res.panic(), std::runtime_error);
+  ASSERT_NO_THROW(ok().panic());
+}
+
+TEST(Result, returnIfError) {
+  bool reached = false;
+  Result res = forward(reached);
+  ASSERT_FALSE(reached);
+  // the original error goes up untouched
+  ASSERT_EQ(res.code(), ErrorCode::NOT_FOUND);
+  ASSERT_EQ(res.site(), fail().site());
+}
+
+TEST(Result, logError) {
+  Result res = error("repeated");
+  testing::internal::CaptureStderr();
+  for (int i = 0; i < 100; ++i) {
+    logError(res);
+  }
+  logError(ok());
+  std::string out = testing::internal::GetCapturedStderr();
+  // printed once, the next 99 wait for the next second
+  ASSERT_EQ(out, res.message() + "\n");
+}
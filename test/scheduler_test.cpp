@@ -0,0 +1,216 @@
+#include <gtest/gtest.h>
+
+#include <arty/core/scheduler.hpp>
+#include <atomic>
+
+using namespace arty;
+
+struct A {
+  int value;
+};
+struct B {
+  int value;
+};
+
+/**
+ * @brief Adds its id to every component T, after reading U if any
+ */
+template <typename T, typename U = void>
+class AddSystem : public System {
+ public:
+  AddSystem(int id) : _id(id) {
+    writes<T>();
+    if constexpr (!std::is_void_v<U>) {
+      reads<U>();
+    }
+    anyThread();
+  }
+
+  Result process(Ptr<Memory> const& mem) override {
+    for (auto [e, t] : mem->view<T>()) {
+      int other = 0;
+      if constexpr (!std::is_void_v<U>) {
+        other = mem->get<U>(e)->value;
+      }
+      t.value = t.value * 10 + _id + other;
+    }
+    return ok();
+  }
+
+ private:
+  int _id;
+};
+
+TEST(ThreadPool, wait) {
+  ThreadPool pool(4);
+  ASSERT_EQ(pool.size(), 4);
+  std::atomic<int> count{0};
+  for (int i = 0; i < 1000; ++i) {
+    pool.submit([&count, &pool] {
+      ++count;
+      pool.submit([&count] { ++count; });
+    });
+  }
+  pool.wait();
+  ASSERT_EQ(count.load(), 2000);
+}
+
+TEST(ThreadPool, serial) {
+  ThreadPool pool(1);
+  ASSERT_EQ(pool.size(), 1);
+  std::vector<int> order;
+  for (int i = 0; i < 10; ++i) {
+    pool.submit([&order, i] { order.push_back(i); });
+  }
+  pool.wait();
+  ASSERT_EQ(order.size(), 10);
+}
+
+TEST(Scheduler, stages) {
+  std::vector<Ptr<System>> systems = {
+      Ptr<System>(new AddSystem<A>(1)),     // stage 0
+      Ptr<System>(new AddSystem<B>(2)),     // stage 0
+      Ptr<System>(new AddSystem<A, B>(3)),  // after both
+      Ptr<System>(new System),              // exclusive
+      Ptr<System>(new AddSystem<B>(4)),     // after the exclusive one
+  };
+  Scheduler scheduler;
+  scheduler.build(systems);
+  std::vector<std::vector<std::size_t>> expected = {{0, 1}, {2}, {3}, {4}};
+  ASSERT_EQ(scheduler.stages(), expected);
+}
+
+TEST(Scheduler, sameAsSerial) {
+  auto simulate = [](std::size_t threads) {
+    Ptr<Memory> mem(new Memory);
+    for (int i = 0; i < 1000; ++i) {
+      Entity e = mem->createEntity();
+      mem->write(e, A{i});
+      mem->write(e, B{-i});
+    }
+    Scheduler scheduler(Ptr<ThreadPool>(new ThreadPool(threads)));
+    scheduler.build({Ptr<System>(new AddSystem<A>(1)),
+                     Ptr<System>(new AddSystem<B>(2)),
+                     Ptr<System>(new AddSystem<A, B>(3)),
+                     Ptr<System>(new AddSystem<B, A>(4))});
+    Ptr<InputManager> inputs(new InputManager);
+    for (int frame = 0; frame < 3; ++frame) {
+      for (auto const& res : scheduler.run(mem, inputs)) {
+        EXPECT_TRUE(res);
+      }
+    }
+    std::vector<int> values;
+    for (auto [e, a, b] : mem->view<A, B>()) {
+      EXPECT_TRUE(e.isValid());
+      values.push_back(a.value);
+      values.push_back(b.value);
+    }
+    return values;
+  };
+  auto serial = simulate(1);
+  ASSERT_EQ(serial.size(), 2000);
+  ASSERT_EQ(simulate(4), serial);
+}
+
+/**
+ * @brief Counts its calls, asleep until T is modified or the event fires
+ */
+template <typename T>
+class SleepySystem : public System {
+ public:
+  SleepySystem(Event const* event) {
+    if (event) {
+      wakesOn(*event);
+    } else {
+      watches<T>();
+    }
+  }
+
+  Result process(Ptr<Memory> const& mem) override {
+    ++calls;
+    if (bump) {
+      // its own modifications do not wake it up
+      for (auto [e, t] : mem->view<T>()) {
+        t.value += 1;
+        mem->touch<T>(e);
+      }
+    }
+    return ok();
+  }
+
+  int calls = 0;
+  bool bump = false;
+};
+
+TEST(Scheduler, wakesOnEvent) {
+  Ptr<Memory> mem(new Memory);
+  Ptr<Keyboard> keyboard(new Keyboard);
+  Ptr<InputManager> inputs(new InputManager);
+  inputs->setKeyboard(keyboard);
+  Event event("WAKE");
+  ASSERT_TRUE(inputs->attach(Keyboard::SPACE, Device::PRESS, event));
+  auto sleepy = std::make_shared<SleepySystem<A>>(&event);
+  Scheduler scheduler;
+  scheduler.build({sleepy});
+
+  Tick tick = mem->tick();
+  scheduler.run(mem, inputs);
+  ASSERT_EQ(sleepy->calls, 0);
+  // nobody ran, the tick did not move
+  ASSERT_EQ(mem->tick(), tick);
+
+  keyboard->process(Keyboard::SPACE, Device::PRESS);
+  scheduler.run(mem, inputs);
+  ASSERT_EQ(sleepy->calls, 0);
+  inputs->flush();
+  ASSERT_TRUE(inputs->pop(event));
+  scheduler.run(mem, inputs);
+  ASSERT_EQ(sleepy->calls, 1);
+  inputs->flush();
+  scheduler.run(mem, inputs);
+  ASSERT_EQ(sleepy->calls, 1);
+
+  // events emitted from code go through the same path
+  inputs->emit(event);
+  inputs->emit(event);
+  inputs->flush();
+  std::vector<int> fired;
+  inputs->fired(fired);
+  ASSERT_EQ(fired, std::vector<int>{event.uuid()});
+  scheduler.run(mem, inputs);
+  ASSERT_EQ(sleepy->calls, 2);
+}
+
+TEST(Scheduler, wakesOnChange) {
+  Ptr<Memory> mem(new Memory);
+  Ptr<InputManager> inputs(new InputManager);
+  auto sleepy = std::make_shared<SleepySystem<A>>(nullptr);
+  ASSERT_TRUE(sleepy->access().reads.test(ComponentRegistry::id<A>()));
+  Scheduler scheduler;
+  scheduler.build({sleepy, Ptr<System>(new AddSystem<B>(1))});
+
+  // nothing to watch yet
+  scheduler.run(mem, inputs);
+  ASSERT_EQ(sleepy->calls, 0);
+
+  Entity e = mem->createEntity();
+  mem->write(e, A{0});
+  mem->write(e, B{0});
+  scheduler.run(mem, inputs);
+  ASSERT_EQ(sleepy->calls, 1);
+  // B changes every run, but it does not watch it
+  scheduler.run(mem, inputs);
+  ASSERT_EQ(sleepy->calls, 1);
+  ASSERT_EQ(mem->get<B>(e)->value, 11);
+
+  sleepy->bump = true;
+  mem->touch<A>(e);
+  scheduler.run(mem, inputs);
+  scheduler.run(mem, inputs);
+  ASSERT_EQ(sleepy->calls, 2);
+  ASSERT_EQ(mem->get<A>(e)->value, 1);
+
+  mem->remove<A>();
+  scheduler.run(mem, inputs);
+  ASSERT_EQ(sleepy->calls, 3);
+}